@@ -14,6 +14,15 @@ using int32 = int32_t;
 constexpr static float default_center[3]{0.f}; // for default value pass to constructor - argument center
 
 
+// range of a 16-bit index buffer drawn with one base vertex (glDrawElementsBaseVertex)
+struct BowlIndexChunk
+{
+    uint32_t base_vertex;
+    uint32_t index_offset;  // first index of the chunk in the index buffer
+    uint32_t index_count;
+};
+
+
 struct ConfigBowl
 {
     float a, b, c;
@@ -103,11 +112,47 @@ public:
             return generate_mesh_(max_size_vert, vertices, indices);
     }
 
+    /*
+        level-of-detail mesh with hole and texture coordinates: rings (radius) x segments (theta) grid,
+        rings spaced densely near the hole (vehicle) and the disk/paraboloid transition.
+        (u, v) map to the same stitched texture position as generate_mesh_uv_hole.
+        indices: 16-bit triangle strips separated by strip_restart, see generate_strip_chunks
+    */
+    bool generate_mesh_lod(const uint rings, const uint segments, const float hole_radius,
+                           const uint band_columns, std::vector<float>& vertices,
+                           std::vector<uint16_t>& indices, std::vector<BowlIndexChunk>& chunks);
+
+    /*
+        strips for a rows x cols grid in chunks of whole rows with at most 65535 vertices each,
+        so indices fit 16 bits relative to the chunk base vertex. Inside a chunk the columns are
+        cut into bands of band_columns quads and every band is walked row pair by row pair,
+        one short strip each: the previous row is still in the post-transform cache, so most
+        vertices are shaded once. A FIFO cache of N entries needs 2 * (band_columns + 1) <= N,
+        as the first strip of a band loads both of its rows. Strips are separated by
+        strip_restart (primitive restart)
+    */
+    static bool generate_strip_chunks(const uint rows, const uint cols, const uint band_columns,
+                                      std::vector<uint16_t>& indices, std::vector<BowlIndexChunk>& chunks);
+
+    // average cache miss ratio (transformed vertices per triangle) with a FIFO cache of cache_size
+    static float strip_acmr(const std::vector<uint16_t>& indices, const std::vector<BowlIndexChunk>& chunks,
+                            const uint cache_size);
+
+    constexpr static uint16_t strip_restart = 0xFFFF;
+
+    // texture coordinates reach 1 + eps_uv; compact vertices store them divided by this
+    constexpr static float uv_scale = 1.f + eps_uv;
+
+    // longest edge of a generate_mesh_lod mesh (radial or angular), in mesh units
+    float lod_max_edge(const uint rings, const uint segments, const float hole_radius) const;
+
 protected:
     bool generate_mesh_(const float max_size_vert, std::vector<float>& vertices, std::vector<uint>& indices);
 
 private:
     void generate_indices(std::vector<uint>& indices, const uint grid_size, const uint idx_min_y, const int32 last_vert);
+    void generate_indices(std::vector<uint>& indices, const uint rows, const uint cols, const uint idx_min_y, const int32 last_vert);
+    std::vector<float> lod_radii(const uint rings, const float hole_radius) const;
 
     // compare inner radius and outer radius
     bool lt_radius(const float x, const float z, const float radius) {
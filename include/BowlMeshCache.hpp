@@ -0,0 +1,97 @@
+#ifndef BOWL_MESH_CACHE_HPP
+#define BOWL_MESH_CACHE_HPP
+
+#include "Bowl.hpp"
+#include "MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Generated bowl mesh of one level of detail
+ */
+struct BowlMeshLod {
+    uint32_t rings = 0;
+    uint32_t segments = 0;
+    float max_edge = 0.0f;
+    std::vector<float> vertices;        // Interleaved (x, y, z, u, v)
+    std::vector<uint16_t> indices;      // Triangle strips, Bowl::strip_restart between strips
+    std::vector<BowlIndexChunk> chunks; // Base vertex + index range of each 16-bit chunk
+    float acmr = 0.0f;                  // Vertex cache misses per triangle (simulated)
+};
+
+/**
+ * @brief Binary on-disk cache of the bowl LOD meshes
+ *
+ * The bowl parameters are fixed per deployment, so the generated vertex
+ * and index buffers are written once and memory-mapped on later starts.
+ * The file carries a format version and the generator inputs (ConfigBowl
+ * shape parameters, strip band width, rings x segments of every LOD); any mismatch makes
+ * load() fail and the caller regenerates and saves a new file.
+ */
+class BowlMeshCache {
+public:
+    /**
+     * @brief Read-only view of one LOD inside the mapped file
+     */
+    struct LodView {
+        uint32_t rings;
+        uint32_t segments;
+        float max_edge;
+        float acmr;
+        const float* vertices;
+        size_t vertex_floats;
+        const uint16_t* indices;
+        size_t index_count;
+        const BowlIndexChunk* chunks;
+        size_t chunk_count;
+    };
+
+    BowlMeshCache();
+    ~BowlMeshCache();
+
+    BowlMeshCache(const BowlMeshCache&) = delete;
+    BowlMeshCache& operator=(const BowlMeshCache&) = delete;
+
+    /**
+     * @brief Map a cache file and check it matches the requested meshes
+     * @param path Cache file
+     * @param config Bowl shape parameters
+     * @param rings Radial rings per LOD
+     * @param segments Angular segments per LOD
+     * @param band_columns Strip band width the indices were ordered with
+     * @return true if the file is valid for these parameters
+     */
+    bool load(const std::string& path, const ConfigBowl& config,
+              const std::vector<uint32_t>& rings, const std::vector<uint32_t>& segments,
+              uint32_t band_columns);
+
+    /**
+     * @brief Write meshes to a cache file (via a temporary file and rename)
+     * @param path Cache file
+     * @param config Bowl shape parameters
+     * @param band_columns Strip band width the indices were ordered with
+     * @param lods Generated meshes
+     * @return true if successful
+     */
+    static bool save(const std::string& path, const ConfigBowl& config, uint32_t band_columns,
+                     const std::vector<BowlMeshLod>& lods);
+
+    /**
+     * @brief Unmap the file (views become invalid)
+     */
+    void release();
+
+    size_t getLodCount() const { return lods.size(); }
+    const LodView& getLod(const size_t idx) const { return lods[idx]; }
+
+    // Bump when the generator or the file layout changes
+    static constexpr uint32_t VERSION = 2;
+
+private:
+    MappedFile file;
+    std::vector<LodView> lods;
+};
+
+#endif // BOWL_MESH_CACHE_HPP
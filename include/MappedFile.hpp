@@ -0,0 +1,95 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file (binary caches loaded in place)
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file
+     * @param path File to map
+     * @param min_size Smallest valid size (e.g. the file header)
+     * @param magic Expected first bytes of the file, nullptr for none
+     * @param magic_size Length of magic
+     * @return false if the file is missing, too small, has another magic or cannot be mapped
+     */
+    bool open(const std::string& path, size_t min_size, const char* magic = nullptr, size_t magic_size = 0);
+
+    /**
+     * @brief Unmap the file (pointers into it become invalid)
+     */
+    void release();
+
+    bool isOpen() const { return mapped != nullptr; }
+    const uint8_t* data() const { return static_cast<const uint8_t*>(mapped); }
+    size_t size() const { return mapped_size; }
+
+private:
+    void* mapped;
+    size_t mapped_size;
+};
+
+/**
+ * @brief Writes a file through "<path>.tmp", renamed over path by commit()
+ *
+ * Readers never see a partially written file. The temporary file is
+ * removed if the writer is destroyed without a successful commit().
+ */
+class AtomicFileWriter {
+public:
+    // Alignment of the data blocks in the mapped cache files
+    static constexpr size_t DATA_ALIGNMENT = 64;
+
+    explicit AtomicFileWriter(const std::string& path);
+    ~AtomicFileWriter();
+
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    /**
+     * @brief The temporary file could be created
+     */
+    bool isOpen() const { return static_cast<bool>(out); }
+
+    void write(const void* data, size_t size);
+
+    /**
+     * @brief Zero-fill up to an absolute file offset
+     */
+    void padTo(uint64_t offset);
+
+    /**
+     * @brief Close the temporary file and rename it to the final path
+     * @return false if writing or renaming failed (the temporary file is removed)
+     */
+    bool commit();
+
+    const std::string& getTmpPath() const { return tmp_path; }
+
+    /**
+     * @brief Next DATA_ALIGNMENT boundary at or after offset
+     */
+    static size_t alignUp(const size_t offset) {
+        return (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    }
+
+private:
+    std::string path;
+    std::string tmp_path;
+    std::ofstream out;
+    bool committed;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -5,6 +5,7 @@
 #include <glm.hpp>
 
 #include <Shader.hpp>
+#include <VertexPacking.hpp>
 
 
 
@@ -19,6 +20,14 @@ struct Vertex
         position(position_), normal(normal_), texcoords(texcoords_) {}
 };
 
+// Vertex in 16 instead of 32 bytes (compact meshes)
+struct PackedVertex
+{
+    int16_t position[4];    // snorm16, Mesh position dequant; w unused
+    int16_t normal[2];      // octahedral, snorm16
+    uint16_t texcoords[2];  // half float (wrapped texcoords exceed [0, 1])
+};
+
 typedef enum{
     tex_DIFFUSE,
     tex_SPECULAR,
@@ -68,8 +77,15 @@ public:
     MaterialInfo material;
 
 public:
+    // compact: upload PackedVertex (shaders built with COMPACT_VERTICES)
     Mesh(const std::vector<Vertex>& vertices_, const std::vector<uint>& indices_ ,
-         const std::vector<Texture>& textures_, const MaterialInfo& material_);
+         const std::vector<Texture>& textures_, const MaterialInfo& material_, const uint materialIndex_ = 0,
+         const bool compact_ = false);
+
+    // upload only, no CPU copy (vertices and indices stay empty), e.g. from a mapped ModelBinary
+    Mesh(const Vertex* vertices_, const size_t vertex_count, const uint* indices_, const size_t index_count,
+         const std::vector<Texture>& textures_, const MaterialInfo& material_, const uint materialIndex_ = 0,
+         const bool compact_ = false);
 
     Mesh(const Mesh&) = delete;
     Mesh& operator=(const Mesh&) = delete;
@@ -78,15 +94,30 @@ public:
     Mesh& operator=(Mesh&&) = default;
 
     void Draw(Shader& shader);
+    // material values come from the "Material" uniform block bound by Model::Draw;
+    // instances > 1: instanced draw (gl_InstanceID selects the view in the shaders)
+    void Draw(const GLuint program, const GLsizei instances = 1);
 
     void clearBuffers();
 
     uint getVAO() const {return VAO;}
     uint getVBO() const {return VBO;}
     uint getEBO() const {return EBO;}
+    uint getMaterialIndex() const {return materialIndex;}
+    bool isCompact() const {return compact;}
 private:
     GLuint VAO, VBO, EBO;
-    void initMesh();
+    size_t indexCount;
+    uint materialIndex;
+    bool compact;
+    PositionDequant positionDequant;        // compact only
+    std::vector<std::string> samplerNames;  // texture_diffuse1, ... (built once)
+    std::vector<GLint> samplerLocations;    // of samplerNames in samplerProgram
+    GLint positionScaleLocation, positionOffsetLocation;
+    GLuint samplerProgram;
+    void initSamplerNames();
+    void initMesh(const Vertex* vertices_, const size_t vertex_count, const uint* indices_, const size_t index_count);
+    void initCompactMesh(const Vertex* vertices_, const size_t vertex_count);
 
 };
 
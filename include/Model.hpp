@@ -6,30 +6,44 @@
 
 using uchar = unsigned char;
 
+class ModelBinary;
+class TextureDecodePool;
+
+// uniform buffer binding of the "Material" block (std140: Ka, Kd, Ks + shininess)
+constexpr GLuint MODEL_MATERIAL_BINDING = 1;
+
 
 
 class Model
 {
 public:
-    Model() : isInit(false) {}
-    Model(const std::string& pathmodel) : isInit(false) {InitModel(pathmodel);}
+    Model() : isInit(false), compactVertices(false), decodePool(nullptr), materialUBO(0), materialStride(0),
+              materialProgram(0), sourceMeshes(0) {}
+    // compact: PackedVertex buffers, draw with a program built with COMPACT_VERTICES
+    Model(const std::string& pathmodel, const bool compact = false) : Model() {compactVertices = compact; InitModel(pathmodel);}
 
     void InitModel(const std::string& pathmodel);
     void Draw(Shader& shader);
+    // one draw call per material; the program's "Material" block is bound on first use
+    void Draw(const GLuint program, const GLsizei instances = 1);
 
     void clearResource();
 
     bool getModelInit() const {return isInit;}
     size_t getModelTexturesSize() const {return textures_loaded.size();}
     size_t getModelMeshesSize() const {return meshes.size();}
+    size_t getSourceMeshesSize() const {return sourceMeshes;}
     const Mesh& getMesh(const uint idx) {return meshes[idx];}
     const Texture& getTexture(const uint idx) {return textures_loaded[idx];}
 
 
 private:
     void loadModel(const std::string& path);
+    void loadBinary(const ModelBinary& binary);
+    Texture loadTexture(const std::string& path, const TexType typeName);
     void processNode(aiNode* node, const aiScene* scene);
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene);
+    void processMesh(aiMesh* mesh, const aiScene* scene);
+    void initMaterialBuffer();
     MaterialInfo processMaterial(aiMaterial* material);
     std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, const TexType typeName);
 private:
@@ -38,4 +52,21 @@ private:
     std::vector<MaterialInfo> materials;
     std::string directory;
     bool isInit;
+    bool compactVertices;
+    TextureDecodePool* decodePool;  // set while loading: textures decode on workers, upload at the end
+
+    // meshes of one material merged into one vertex/index buffer (Assimp path, while loading)
+    struct MeshBatch
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint> indices;
+        std::vector<Texture> textures;
+        size_t sourceMeshes = 0;
+    };
+    std::vector<MeshBatch> batches;     // by material index
+
+    GLuint materialUBO;
+    GLint materialStride;               // record size rounded to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    GLuint materialProgram;             // program whose block binding was set
+    size_t sourceMeshes;
 };
@@ -0,0 +1,84 @@
+#pragma once
+#include <Mesh.hpp>
+#include <MappedFile.hpp>
+
+#include <assimp/postprocess.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+struct aiMaterial;
+
+// Assimp post-processing of the car model, shared by Model and the converter
+constexpr unsigned int MODEL_IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs;
+
+// Extension appended to the model path for its preprocessed binary
+#define MODEL_BINARY_EXT ".svmodel"
+
+
+MaterialInfo MaterialFromAssimp(aiMaterial* material);
+
+
+/*
+    Preprocessed model: the result of the Assimp import (interleaved Vertex arrays, triangle
+    indices, materials and texture paths) in one file that is memory-mapped at startup.
+    Meshes are stored merged per material, ready for one draw call each.
+    The file records size and modification time of the source model; if either changed,
+    load() fails and the caller falls back to Assimp. Written by the ModelConvert tool.
+*/
+class ModelBinary
+{
+public:
+    struct TextureRef
+    {
+        TexType type;
+        std::string path;   // as in the material, relative to the model directory
+    };
+
+    struct MeshView
+    {
+        const Vertex* vertices;
+        size_t vertex_count;
+        const uint* indices;
+        size_t index_count;
+        uint32_t material;
+        std::vector<TextureRef> textures;
+    };
+
+public:
+    ModelBinary() : source_meshes(0) {}
+    ~ModelBinary() {release();}
+
+    ModelBinary(const ModelBinary&) = delete;
+    ModelBinary& operator=(const ModelBinary&) = delete;
+
+    /*
+        import model_path with Assimp and write binary_path (temporary file + rename)
+    */
+    static bool convert(const std::string& model_path, const std::string& binary_path);
+
+    /*
+        map binary_path; false if missing, corrupt, of another version or older than model_path
+    */
+    bool load(const std::string& binary_path, const std::string& model_path);
+
+    // unmap the file (mesh views become invalid)
+    void release();
+
+    const std::vector<MeshView>& getMeshes() const {return meshes;}
+    const std::vector<MaterialInfo>& getMaterials() const {return materials;}
+    size_t getSourceMeshCount() const {return source_meshes;}
+
+    static std::string binaryPath(const std::string& model_path) {return model_path + MODEL_BINARY_EXT;}
+
+    // bump when the file layout or the import (MODEL_IMPORT_FLAGS, Vertex) changes
+    static constexpr uint32_t VERSION = 2;
+
+private:
+    MappedFile file;
+    size_t source_meshes;
+    std::vector<MeshView> meshes;
+    std::vector<MaterialInfo> materials;
+};
@@ -2,6 +2,7 @@
 #define OGL_SHADER_HPP
 
 #include <string>
+#include <unordered_map>
 #include <GLES3/gl3.h>  // OpenGL ES 3.x for Jetson
 #include <glm/glm.hpp>
 
@@ -9,7 +10,9 @@
  * @brief OpenGL Shader Wrapper
  * 
  * Handles loading, compiling, and using GLSL shaders.
- * Provides methods to set uniform variables.
+ * Provides methods to set uniform variables. Uniform locations are
+ * resolved once after linking; per-frame code should keep the
+ * location from getUniformLocation() and use the location setters.
  */
 class OGLShader {
 public:
@@ -25,11 +28,19 @@ public:
     
     /**
      * @brief Load shader from files
+     *
+     * The linked program is taken from SHADER_CACHE_DIR when an entry for
+     * these sources and this driver exists; otherwise it is compiled and
+     * the program binary is stored there.
      * @param vertexPath Path to vertex shader file
      * @param fragmentPath Path to fragment shader file
+     * @param defines Lines inserted after the #version line of both shaders (e.g. "#define X\n")
+     * @param vertexPreludePath GLSL file inserted after the defines of the vertex shader only
+     *        (declarations shared by several vertex shaders); empty for none
      * @return true if successful
      */
-    bool loadFromFile(const std::string& vertexPath, const std::string& fragmentPath);
+    bool loadFromFile(const std::string& vertexPath, const std::string& fragmentPath,
+                      const std::string& defines = "", const std::string& vertexPreludePath = "");
     
     /**
      * @brief Activate the shader
@@ -37,6 +48,21 @@ public:
     void useProgramm() const;
     void use() const;
     
+    /**
+     * @brief Location of a uniform (from the link-time cache)
+     * @param name Uniform name
+     * @return Location, -1 if the uniform is not active
+     */
+    GLint getUniformLocation(const std::string& name) const;
+    
+    /**
+     * @brief Attach a uniform block to a buffer binding point
+     * @param name Block name
+     * @param binding Binding point (glBindBufferBase target)
+     * @return false if the program has no such block
+     */
+    bool bindUniformBlock(const char* name, GLuint binding) const;
+    
     // Utility uniform functions
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
@@ -51,7 +77,19 @@ public:
     void setMat3(const std::string &name, const glm::mat3 &mat) const;
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
     
+    // Uniform functions by location (no lookup)
+    void setInt(GLint location, int value) const;
+    void setFloat(GLint location, float value) const;
+    void setVec2(GLint location, float x, float y) const;
+    void setVec3(GLint location, float x, float y, float z) const;
+    void setVec4(GLint location, float x, float y, float z, float w) const;
+    void setMat4(GLint location, const glm::mat4 &mat) const;
+    
 private:
+    // Uniform name -> location, filled after linking
+    mutable std::unordered_map<std::string, GLint> uniform_locations;
+    
+
     /**
      * @brief Check for shader compilation/linking errors
      * @param shader Shader ID
@@ -60,6 +98,28 @@ private:
      * @return true if no errors
      */
     bool checkCompileErrors(unsigned int shader, const std::string& type, const std::string& path);
+    
+    /**
+     * @brief Insert defines after the #version line (GLSL requires it first)
+     */
+    static void insertDefines(std::string& code, const std::string& defines);
+    
+    /**
+     * @brief Program binary cache file for a pair of shader sources
+     * @return Empty if the driver supports no program binary format
+     */
+    static std::string binaryCachePath(const std::string& vertexCode, const std::string& fragmentCode);
+    
+    /**
+     * @brief Create the program from a cached binary
+     * @return false if missing or rejected by the driver (ID stays 0)
+     */
+    bool loadProgramBinary(const std::string& path);
+    
+    /**
+     * @brief Store the binary of the linked program
+     */
+    void saveProgramBinary(const std::string& path) const;
 };
 
 #endif // OGL_SHADER_HPP
\ No newline at end of file
@@ -3,21 +3,59 @@
 
 #include "SVConfig.hpp"
 #include "SVEthernetCamera.hpp"
+#include "SVSharedMemoryCamera.hpp"
 #include "SVStitcherSimple.hpp"
 #include "SVRenderSimple.hpp"
+#include "SVBrightnessTracker.hpp"
+#include "SVFrameMailbox.hpp"
+#include "SVPipelineQueue.hpp"
+#include "SVFrameScheduler.hpp"
+#include "SVStreamOutput.hpp"
+#include "SVSharedFrameRing.hpp"
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <array>
 #include <string>
+#include <thread>
 
 /**
  * @brief Simplified Surround View Application
  * 
  * Main application class that orchestrates:
- * - Camera capture from 4 H.264 Ethernet streams
+ * - Camera capture from 4 H.264 Ethernet streams (or, with SHM_INPUT,
+ *   frames decoded by another process in shared memory)
  * - Spherical warping and stitching
  * - Multi-band blending
  * - OpenGL bowl rendering with car overlay
+ * 
+ * Capture, stitching and rendering run as a pipeline, one thread per
+ * stage, so capturing frame N+1 overlaps stitching frame N and rendering:
+ * - capture -> stitch: bounded SPSC queue of PIPELINE_QUEUE_DEPTH frame
+ *   sets; a full queue holds capture back (depth trades latency for throughput)
+ *   and queued sets are stitched in order while the stitch stage keeps its schedule
+ * - stitch -> render: triple-buffer mailbox, the render thread runs at
+ *   display rate and always draws the newest stitched frame
+ * The stitch stage is paced by an SVFrameScheduler at PIPELINE_TARGET_FPS:
+ * once it falls a whole period behind it skips queued frame sets already
+ * superseded by newer ones; it tracks deadline misses and capture-to-output
+ * latency, and wakes the headless render thread on each published frame
+ * instead of polling.
+ * The calling thread only handles window events. With
+ * RENDER_DIRECT_PROJECTION the bowl samples the raw cameras and the
+ * stitcher only runs at the gain update rate. With STREAM_OUTPUT the
+ * rendered view or the stitched canvas is also encoded to H.264, with
+ * SHM_OUTPUT stitched frames are published to a shared-memory ring.
  */
+
+/**
+ * @brief Camera frame set queued between the capture and stitch stages
+ */
+struct SVCaptureSet {
+    std::array<cv::cuda::GpuMat, NUM_CAMERAS> cameras;
+    std::chrono::steady_clock::time_point captured;
+};
+
 class SVAppSimple {
 public:
     SVAppSimple();
@@ -26,13 +64,15 @@ public:
     /**
      * @brief Initialize the system
      * @param calib_folder Path to folder containing calibration YAML files
+     * @param headless Render offscreen (EGL) without a display
      * @return true if initialization successful, false otherwise
      */
-    bool init(const std::string& calib_folder);
+    bool init(const std::string& calib_folder, bool headless = false);
     
     /**
      * @brief Run main loop (blocking)
-     * Captures frames, stitches, and renders until stopped
+     * Starts the capture, stitch and render threads and processes
+     * window events until stopped
      */
     void run();
     
@@ -41,20 +81,91 @@ public:
      */
     void stop();
     
+    /**
+     * @brief Ask the main loop to exit (async-signal-safe)
+     */
+    void requestStop() { is_running = false; }
+    
 private:
+    /**
+     * @brief Render thread body: owns the GL context while running
+     */
+    void renderLoop();
+    
+    /**
+     * @brief Capture stage: camera frame sets into capture_queue
+     */
+    void captureLoop();
+    
+    /**
+     * @brief Stitch stage: capture_queue into the render mailbox, gain updates, outputs
+     */
+    void stitchLoop();
+    
+    /**
+     * @brief Wake and join the stage threads (is_running must be cleared)
+     */
+    void joinPipeline();
+    
+    /**
+     * @brief Print per-stage times and queue occupancy since the last call
+     */
+    void printPipelineStats();
+    
+    /**
+     * @brief Hand a frame to the output stream, opening it on the first frame
+     * @param frame BGRA rendered frame or BGR stitched canvas
+     * @param bottom_up Rows in OpenGL order (readback)
+     */
+    void streamFrame(const cv::Mat& frame, bool bottom_up);
+    
+    /**
+     * @brief Download a stitched frame into the shared-memory ring, creating it on the first frame
+     * @param stitched Stitched canvas
+     * @param captured Capture time of the camera frames it was stitched from
+     */
+    void publishShared(const cv::cuda::GpuMat& stitched, std::chrono::steady_clock::time_point captured);
+    
     // Camera source
     std::shared_ptr<MultiCameraSource> camera_source;
-    std::array<Frame, NUM_CAMERAS> frames;
+    std::array<Frame, NUM_CAMERAS> frames;   // Capture thread only once running
+    
+    // Pipeline: capture -> capture_queue -> stitch -> frame_mailbox -> render
+    SVSpscQueue<SVCaptureSet> capture_queue;
+    std::thread capture_thread;
+    std::thread stitch_thread;
+    SVStageMetrics capture_metrics;
+    SVStageMetrics stitch_metrics;
+    SVStageMetrics render_metrics;
+    SVFrameScheduler frame_scheduler;
     
     // Stitching
     std::shared_ptr<SVStitcherSimple> stitcher;
-    cv::cuda::GpuMat stitched_output;
     
     // Rendering
     std::shared_ptr<SVRenderSimple> renderer;
+    SVFrameMailbox<SVRenderFrame> frame_mailbox;
+    bool is_direct;                      // Bowl textured from the raw cameras
+    cv::cuda::GpuMat stats_output;       // Stitch target in direct mode (exposure statistics only)
+    std::thread render_thread;
+    std::atomic<unsigned long> rendered_frames;
+    
+    // H.264 output (STREAM_OUTPUT)
+    std::unique_ptr<SVStreamOutput> stream_output;
+    bool stream_failed;                  // Opening failed, stop trying
+    cv::Mat stream_canvas;               // Host copy of the stitched canvas
+    
+    // Shared-memory ring of stitched frames (SHM_OUTPUT)
+    std::unique_ptr<SVShmFramePublisher> shm_publisher;
+    bool shm_failed;                     // Creating the ring failed, stop trying
+    bool shm_pinned;                     // Ring slots registered as page-locked with CUDA
+    
+    // Scene-change driven gain updates
+    SVBrightnessTracker brightness_tracker;
     
     // State
-    bool is_running;
+    std::atomic<bool> is_running;
+    bool is_headless;
     std::string calibration_folder;
 };
 
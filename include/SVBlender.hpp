@@ -88,7 +88,7 @@ protected:
 private:
         cudaStream_t _cudaStreamDst;
 public:
-        SVMultiBandBlender(const int numbands_ = 1);
+        SVMultiBandBlender(const int numbands_ = 1, const int statslevel_ = -1);
         ~SVMultiBandBlender();
 
         void prepare(const std::vector<cv::Point> &corners, const std::vector<cv::Size> &sizes, const std::vector<cv::cuda::GpuMat>& masks);
@@ -102,6 +102,11 @@ public:
 
         void blend(cv::cuda::GpuMat &dst, const bool apply_mask=true, cv::cuda::Stream& streamObj = cv::cuda::Stream::Null());
 
+        /* Gaussian level statslevel_ of every fed image (CV_16SC3), its 8U mask and its corner at that level.
+           Snapshot taken during feed(), before the level is replaced by its Laplacian. */
+        bool getStatsLevel(std::vector<cv::cuda::GpuMat>& imgs, std::vector<cv::cuda::GpuMat>& masks,
+                           std::vector<cv::Point>& corners) const;
+
 private:
         void prepare_pyr(const cv::Rect& dst_roi);
         void prepare_roi(const std::vector<cv::Point> &corners, const std::vector<cv::Size> &sizes);
@@ -116,6 +121,10 @@ protected:
         std::vector<std::vector<cv::cuda::GpuMat>> gpu_weight_pyr_gauss_vec_;
         std::vector<std::vector<cv::cuda::GpuMat>> gpu_src_pyr_laplace_vec_;
         std::vector<std::vector<cv::cuda::GpuMat>> gpu_ups_;
+        std::vector<cv::cuda::GpuMat> gpu_stats_gauss_;
+        std::vector<cv::cuda::GpuMat> gpu_stats_masks_;
+        std::vector<cv::Point> stats_corners_;
         int numbands;
+        int statslevel;
 };
 
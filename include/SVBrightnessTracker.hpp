@@ -0,0 +1,64 @@
+#ifndef SV_BRIGHTNESS_TRACKER_HPP
+#define SV_BRIGHTNESS_TRACKER_HPP
+
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * @brief Per-camera brightness drift tracker
+ * 
+ * Decides when gain compensation has to be recomputed instead of
+ * running it on a fixed timer:
+ * - Takes the mean luma of every camera (measured on a decimated grid)
+ * - Compares it with the luma seen at the last gain update
+ * - Triggers an update when the relative drift of any camera crosses
+ *   the threshold, at most once per minimum interval
+ */
+class SVBrightnessTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    /**
+     * @brief Constructor
+     * @param cams_num Number of cameras
+     * @param drift_threshold Relative luma drift that triggers an update (0.05 = 5%)
+     * @param min_interval_ms Minimum time between two updates
+     */
+    SVBrightnessTracker(const size_t cams_num, const float drift_threshold, const int min_interval_ms);
+    
+    /**
+     * @brief Feed the current per-camera luma
+     * @param lumas Mean luma of every camera (before gain compensation)
+     * @param now Current time
+     * @return true if gains should be recomputed now
+     */
+    bool update(const std::vector<double>& lumas, const Clock::time_point& now);
+    
+    /**
+     * @brief Largest relative drift seen by the last update() call
+     */
+    float getMaxDrift() const { return max_drift; }
+    
+    /**
+     * @brief Number of gain updates triggered so far
+     */
+    size_t getUpdateCount() const { return update_count; }
+    
+    /**
+     * @brief Number of frames whose drift crossed the threshold but were rate limited
+     */
+    size_t getSuppressedCount() const { return suppressed_count; }
+    
+private:
+    std::vector<double> reference_lumas;    // Luma at the last gain update
+    Clock::time_point last_update;
+    Clock::duration min_interval;
+    float threshold;
+    float max_drift;
+    size_t update_count;
+    size_t suppressed_count;
+    size_t num_cameras;
+};
+
+#endif // SV_BRIGHTNESS_TRACKER_HPP
@@ -52,8 +52,16 @@ static const CameraConfig CAMERA_CONFIGS[NUM_CAMERAS] = {
 // Higher = slower but higher quality
 #define PROCESS_SCALE 0.65f
 
-// Gain compensation update interval (seconds)
-#define GAIN_UPDATE_INTERVAL 10
+// Gain compensation is recomputed when the mean luma of any camera
+// drifts by more than this fraction since the last update
+#define GAIN_DRIFT_THRESHOLD 0.05f
+
+// Minimum time between two gain updates (milliseconds)
+#define GAIN_MIN_UPDATE_INTERVAL_MS 100
+
+// Blender pyramid level used for gain statistics (must be <= NUM_BLEND_BANDS)
+// Level 3 = 1/8 of the processing resolution
+#define GAIN_STATS_LEVEL 3
 
 // ============================================================
 // RENDERING CONFIGURATION
@@ -65,11 +73,135 @@ static const CameraConfig CAMERA_CONFIGS[NUM_CAMERAS] = {
 #define BOWL_HOLE_RADIUS 0.08f
 #define BOWL_VERTICES 750
 
+// Bowl level-of-detail meshes, finest first (radial rings x angular segments)
+#define BOWL_LOD_COUNT 3
+#define BOWL_LOD_RINGS { 192, 96, 48 }
+#define BOWL_LOD_SEGMENTS { 256, 128, 64 }
+
+// Post-transform vertex cache size the bowl strips are ordered for
+// (bands of BOWL_VERTEX_CACHE_SIZE / 2 - 1 quads, see Bowl::generate_strip_chunks)
+#define BOWL_VERTEX_CACHE_SIZE 16
+
+// Coarsest LOD is used whose longest edge projects to at most this many pixels
+#define BOWL_LOD_MAX_EDGE_PIXELS 24.0f
+
+// Generated bowl meshes are stored here and memory-mapped on later starts
+// (regenerated when the bowl parameters or LOD sizes change)
+#define BOWL_CACHE_PATH "bowl_mesh.cache"
+
+// Limits of the disk radius set by SVRenderSimple::setObstacleDistance (bowl units)
+#define BOWL_MIN_DISK_RADIUS 0.15f
+#define BOWL_MAX_DISK_FRACTION 0.9f
+
 // Camera view parameters
 #define CAMERA_FOV 45.0f
 #define CAMERA_POSITION_Y 2.0f
 #define CAMERA_POSITION_Z 5.0f
 
+// Number of pixel unpack buffers cycled for the stitched texture upload
+#define RENDER_PBO_COUNT 3
+
+// Pixel pack buffers cycled for the asynchronous readback of rendered frames
+// (SVRenderSimple::setReadbackCallback); a frame is delivered RENDER_READBACK_PBO_COUNT - 1
+// frames later at the latest, and skipped if every buffer is still in flight
+#define RENDER_READBACK_PBO_COUNT 3
+
+// Compact vertex buffers: 16-bit positions (per-mesh scale and offset), octahedral
+// normals and 16-bit texcoords instead of 32-bit floats (bowl 12 instead of 20 bytes,
+// car 16 instead of 32 bytes per vertex). Shaders are built with COMPACT_VERTICES.
+#define RENDER_COMPACT_VERTICES 1
+
+// Uniform buffer binding of the shared view/projection block ("Camera" in the vertex shaders)
+#define RENDER_CAMERA_BINDING 0
+
+// Multi-view layout: the 3D view and a top-down view side by side, both drawn by one
+// instanced draw per mesh with per-view matrices in the Camera block. With direct
+// projection two raw camera tiles (camera indices below) fill the lower half (2x2 grid).
+#define RENDER_MULTIVIEW 0
+#define RENDER_MULTIVIEW_CAMERAS { 0, 2 }
+#define RENDER_TOP_VIEW_HEIGHT 8.0f
+
+// Size of the per-view arrays in the Camera block (MAX_VIEWS in the shaders)
+#define RENDER_MAX_VIEWS 2
+
+// Linked shader programs are stored here (glGetProgramBinary) and reloaded on later starts;
+// entries are keyed by the shader sources and the GL vendor/renderer/version
+#define SHADER_CACHE_DIR "shader_cache"
+
+// Texture the bowl straight from the camera images (per-vertex camera
+// texcoords and blend weights) instead of the stitched panorama.
+// The stitcher then only runs at the gain update rate for exposure statistics.
+#define RENDER_DIRECT_PROJECTION 0
+
+// Width of the blend ramp at the camera image borders (fraction of the image)
+#define DIRECT_PROJECTION_FEATHER 0.08f
+
+// Headless mode (--headless): write the rendered frame every N frames
+// (0 = never). The file is overwritten each time.
+#define HEADLESS_SNAPSHOT_EVERY 300
+#define HEADLESS_SNAPSHOT_PATH "headless_frame.png"
+
+// ============================================================
+// PIPELINE
+// ============================================================
+
+// Camera frame sets queued between the capture and stitch threads. 1 keeps latency
+// lowest; more lets capture run ahead while a stitch takes longer than a frame period.
+// Queued sets are stitched in order; only once the stitch stage falls a whole output
+// period behind (PIPELINE_TARGET_FPS) are all but the newest dropped.
+#define PIPELINE_QUEUE_DEPTH 2
+
+// Main thread wakes at least this often to check for a stop request
+#define PIPELINE_EVENT_TIMEOUT_MS 50
+
+// Output frame rate the stitch stage is scheduled for. Frame sets arriving faster
+// are skipped, queued ones superseded by a newer set are dropped, and a frame
+// finished after the start of the next slot counts as a deadline miss
+#define PIPELINE_TARGET_FPS 30.0f
+
+// ============================================================
+// OUTPUT STREAM
+// ============================================================
+
+// H.264 output stream (SVStreamOutput): 0 = off, 1 = rendered view (asynchronous
+// readback), 2 = stitched canvas. Opened on the first frame, which sets its size.
+#define STREAM_OUTPUT 0
+
+// "udp://host:port" for RTP/UDP (payload 96), otherwise a file path
+// (.mp4 / .mkv are muxed, other names get a raw H.264 byte stream)
+#define STREAM_TARGET "udp://127.0.0.1:5000"
+#define STREAM_FPS 30
+#define STREAM_BITRATE_KBPS 4000
+
+// Frames copied for the encoder but not yet consumed; further frames are dropped
+#define STREAM_QUEUE_DEPTH 3
+
+// ============================================================
+// SHARED MEMORY INPUT
+// ============================================================
+
+// Take decoded camera frames from shared-memory rings written by another process
+// (SharedMemoryCameraSource) instead of receiving and decoding the RTP streams.
+// Ring names are SHM_INPUT_PREFIX + camera index (/sv_cam0 .. /sv_cam3).
+#define SHM_INPUT 0
+#define SHM_INPUT_PREFIX "/sv_cam"
+
+// Wait for the producer (attach) and for each camera frame
+#define SHM_INPUT_TIMEOUT_MS 1000
+
+// ============================================================
+// SHARED MEMORY OUTPUT
+// ============================================================
+
+// Publish each stitched frame to a POSIX shared-memory ring (SVShmFramePublisher) for
+// other local processes; readers link svshmring (SVShmFrameReader, see tools/ShmLatencyTest).
+// In direct projection mode frames are only stitched at the gain update rate.
+#define SHM_OUTPUT 0
+#define SHM_OUTPUT_NAME "/sv_stitched"
+
+// Frames kept in the ring; a reader has SHM_OUTPUT_SLOTS - 1 frame periods to use a frame in place
+#define SHM_OUTPUT_SLOTS 4
+
 // ============================================================
 // DEBUG OPTIONS
 // ============================================================
@@ -98,21 +98,24 @@ private:
 
 /**
  * @brief Multi-camera synchronized source - matches original interface
+ *
+ * Receives and decodes the four Ethernet camera streams. Subclasses replace
+ * the frame source (see SharedMemoryCameraSource) and keep the undistortion.
  */
 class MultiCameraSource {
 public:
     MultiCameraSource();
-    ~MultiCameraSource();
+    virtual ~MultiCameraSource();
     
     // Interface matching original SVCamera
-    int init(const std::string& param_filepath, const cv::Size& calibSize, 
-             const cv::Size& undistSize, const bool useUndist = false);
-    bool startStream();
-    bool stopStream();
-    bool capture(std::array<Frame, CAM_NUMS>& frames);
-    bool setFrameSize(const cv::Size& size);
+    virtual int init(const std::string& param_filepath, const cv::Size& calibSize, 
+                     const cv::Size& undistSize, const bool useUndist = false);
+    virtual bool startStream();
+    virtual bool stopStream();
+    virtual bool capture(std::array<Frame, CAM_NUMS>& frames);
+    virtual bool setFrameSize(const cv::Size& size);
     
-    void close();
+    virtual void close();
     
     // Getters matching original interface
     const EthernetCameraSource& getCamera(int index) const { return _cams[index]; }
@@ -125,15 +128,33 @@ public:
     bool _undistort = true;
     std::array<cv::Mat, CAM_NUMS> Ks;  // Camera matrices
     
-private:
-    // Camera sources - 4 Ethernet cameras
-    std::array<EthernetCameraSource, CAM_NUMS> _cams;
+protected:
+    /**
+     * @brief Constructor for subclasses with their own frame source
+     * @param ethernetCameras false: no Ethernet camera sources and no CUDA streams are created
+     */
+    explicit MultiCameraSource(const bool ethernetCameras);
+    
+    /**
+     * @brief Load calibration and build the undistortion maps (disables _undistort on failure)
+     */
+    void initUndistortion(const std::string& param_filepath, const cv::Size& calibSize,
+                          const cv::Size& undistSize);
+    
+    /**
+     * @brief Undistort a decoded frame into frame.gpuFrame (or pass it through)
+     */
+    void undistortFrame(size_t idx, cv::cuda::GpuMat& rawFrame, Frame& frame);
     
     // Frame processing
     cv::Size frameSize;
     std::array<InternalCameraParams, CAM_NUMS> camIparams;
     std::array<CameraUndistortData, CAM_NUMS> undistFrames;
     
+private:
+    // Camera sources - 4 Ethernet cameras (none for subclasses with their own frame source)
+    std::vector<EthernetCameraSource> _cams;
+    
     // CUDA streams for parallel processing
     cudaStream_t _cudaStream[CAM_NUMS];
     cv::cuda::Stream cudaStreamObj;
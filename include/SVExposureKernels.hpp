@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * Host (CPU) equivalents of the gain compensation kernels in cusrc/kernelgain.cu
+ *
+ * Same entry points, argument order and output layout as the cuda* host
+ * functions, so results are interchangeable:
+ * - images are packed (row step = width * channels), channels = 1..3
+ * - mean[channels] and gain[channels * 2] hold the pixel count stored as int bits
+ *
+ * Rows are split in bands processed in parallel (cv::parallel_for_),
+ * inner loops use OpenCV universal intrinsics for 1 and 3 channel images
+ * (histograms: bin computation only, the counts go to per-lane sub-histograms).
+ * 16S variants take the CV_16SC3 images fed to the blender.
+ */
+
+extern "C" {
+    void cpuComputeHistogram(const unsigned char* image, unsigned int* histogram,
+                             int width, int height, int channels);
+    void cpuComputeHistogram16s(const short* image, unsigned int* histogram,
+                                int width, int height, int channels);
+
+    void cpuComputeMean(const unsigned char* image, float* mean, const unsigned char* mask,
+                        int width, int height, int channels);
+    void cpuComputeMean16s(const short* image, float* mean, const unsigned char* mask,
+                           int width, int height, int channels);
+
+    void cpuApplyGain(const unsigned char* src, unsigned char* dst, const float* gains,
+                      int width, int height, int channels);
+    void cpuApplyGain16s(const short* src, short* dst, const float* gains,
+                         int width, int height, int channels);
+
+    void cpuComputeOverlapGain(const unsigned char* img1, const unsigned char* img2, const unsigned char* mask,
+                               float* gain, int width, int height, int channels);
+    void cpuComputeOverlapGain16s(const short* img1, const short* img2, const unsigned char* mask,
+                                  float* gain, int width, int height, int channels);
+}
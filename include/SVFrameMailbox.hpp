@@ -0,0 +1,111 @@
+#ifndef SV_FRAME_MAILBOX_HPP
+#define SV_FRAME_MAILBOX_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Lock-free single-producer / single-consumer triple buffer
+ *
+ * Hands the newest frame from one thread to another without blocking:
+ * - The producer fills writeSlot() and calls publish()
+ * - The consumer calls acquire() and reads readSlot()
+ * - A frame published before the previous one was picked up replaces it (dropped)
+ * - acquire() without a new frame keeps the last one (repeated)
+ *
+ * Slots are reused, so a T that owns storage (cv::cuda::GpuMat, cv::Mat)
+ * is reallocated only when the frame size changes.
+ */
+template <typename T>
+class SVFrameMailbox {
+public:
+    SVFrameMailbox()
+        : shared_state(1), back_index(0), front_index(2), has_frame(false),
+          published(0), dropped(0), repeated(0) {}
+
+    SVFrameMailbox(const SVFrameMailbox&) = delete;
+    SVFrameMailbox& operator=(const SVFrameMailbox&) = delete;
+
+    /**
+     * @brief Slot owned by the producer (valid until publish())
+     */
+    T& writeSlot() { return slots[back_index]; }
+
+    /**
+     * @brief Make the write slot the newest frame (producer thread)
+     */
+    void publish() {
+        const uint8_t prev = shared_state.exchange(back_index | FRESH_BIT, std::memory_order_acq_rel);
+        if (prev & FRESH_BIT) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        back_index = prev & INDEX_MASK;
+        published.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Take the newest frame if there is one (consumer thread)
+     * @return true if readSlot() changed since the last call
+     */
+    bool acquire() {
+        if (!(shared_state.load(std::memory_order_acquire) & FRESH_BIT)) {
+            if (has_frame) {
+                repeated.fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        }
+
+        const uint8_t prev = shared_state.exchange(front_index, std::memory_order_acq_rel);
+        front_index = prev & INDEX_MASK;
+        has_frame = true;
+        return true;
+    }
+
+    /**
+     * @brief Check for an unread frame without taking it (consumer thread)
+     */
+    bool hasNewFrame() const {
+        return (shared_state.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+    }
+
+    /**
+     * @brief Slot owned by the consumer (valid until the next acquire())
+     */
+    const T& readSlot() const { return slots[front_index]; }
+
+    /**
+     * @brief true once the consumer has received at least one frame
+     */
+    bool hasFrame() const { return has_frame; }
+
+    unsigned long getPublishedCount() const { return published.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Frames overwritten before the consumer picked them up
+     */
+    unsigned long getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief acquire() calls that found no new frame
+     */
+    unsigned long getRepeatedCount() const { return repeated.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    T slots[3];
+
+    // Index of the middle slot plus FRESH_BIT when it holds an unread frame
+    std::atomic<uint8_t> shared_state;
+
+    uint8_t back_index;     // Producer only
+    uint8_t front_index;    // Consumer only
+    bool has_frame;         // Consumer only
+
+    std::atomic<unsigned long> published;
+    std::atomic<unsigned long> dropped;
+    std::atomic<unsigned long> repeated;
+};
+
+#endif // SV_FRAME_MAILBOX_HPP
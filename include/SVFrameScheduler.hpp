@@ -0,0 +1,121 @@
+#ifndef SV_FRAME_SCHEDULER_HPP
+#define SV_FRAME_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Deadline-driven pacing of the output frames
+ *
+ * Replaces fixed sleeps with a schedule derived from the target output rate:
+ * - Output slots are one period apart; a frame set admitted into a slot has
+ *   to be finished by the start of the next slot, otherwise it is a deadline miss
+ * - Frame sets arriving more than half a period before their slot are
+ *   skipped (source faster than the target rate)
+ * - Slots are re-anchored after a stall instead of bursting to catch up
+ * - isBehind() tells when queued frame sets are stale (a whole slot missed)
+ * - Capture-to-output latency is recorded per frame (mean, jitter, max)
+ *
+ * Consumers that wait for output frames block in waitForFrame() and are
+ * woken by notifyFrame() as soon as one is published, instead of polling.
+ *
+ * admit(), complete(), addSkippedStale() and take() belong to the thread
+ * producing the output frames; notifyFrame() / waitForFrame() work across threads.
+ */
+class SVFrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Per-interval statistics, see take()
+     */
+    struct Sample {
+        unsigned long frames = 0;
+        unsigned long misses = 0;           // Finished after the deadline
+        unsigned long skipped_stale = 0;    // Superseded by a newer frame set
+        unsigned long skipped_early = 0;    // Ahead of the target rate
+        float max_late_ms = 0.0f;           // Worst deadline overrun
+        float latency_ms = 0.0f;            // Mean capture to output
+        float latency_jitter_ms = 0.0f;     // Standard deviation of the latency
+        float latency_max_ms = 0.0f;
+    };
+
+    /**
+     * @brief Constructor
+     * @param target_fps Output frame rate to schedule for
+     */
+    explicit SVFrameScheduler(const float target_fps);
+
+    /**
+     * @brief Assign a slot to a frame set that is ready to be processed
+     * @param now Current time
+     * @return false if the frame set is ahead of the target rate and should be skipped
+     */
+    bool admit(const Clock::time_point& now);
+
+    /**
+     * @brief A whole output slot passed since the last admitted frame's deadline
+     *
+     * Only then are queued frame sets stale; otherwise the queue absorbs
+     * capture jitter and its sets are processed in order.
+     * @param now Current time
+     */
+    bool isBehind(const Clock::time_point& now) const { return anchored && now > next_slot + period; }
+
+    /**
+     * @brief Record the end of the admitted frame
+     * @param captured Capture time of its frame set
+     * @param now Current time
+     * @return false if the deadline was missed
+     */
+    bool complete(const Clock::time_point& captured, const Clock::time_point& now);
+
+    /**
+     * @brief Count frame sets dropped because newer ones were already waiting
+     */
+    void addSkippedStale(const unsigned long count) { interval.skipped_stale += count; skipped_total += count; }
+
+    /**
+     * @brief Statistics since the last call, then reset
+     */
+    Sample take();
+
+    /**
+     * @brief Signal that a new output frame is available (any thread)
+     */
+    void notifyFrame();
+
+    /**
+     * @brief Block until notifyFrame() was called since the previous wait (one consumer)
+     * @param timeout Maximum wait
+     * @return true if woken by a frame
+     */
+    bool waitForFrame(const Clock::duration& timeout);
+
+    Clock::duration getPeriod() const { return period; }
+    unsigned long getMissCount() const { return misses_total; }
+    unsigned long getSkippedCount() const { return skipped_total; }
+
+private:
+    Clock::duration period;
+    Clock::time_point next_slot;
+    Clock::time_point deadline;             // Of the frame admitted last
+    bool anchored;
+
+    // Statistics (output thread)
+    Sample interval;
+    double latency_sum;
+    double latency_sq_sum;
+    unsigned long misses_total;
+    unsigned long skipped_total;
+
+    // Frame arrival
+    std::mutex frame_mutex;
+    std::condition_variable frame_cond;
+    uint64_t frame_generation;
+    uint64_t seen_generation;               // Consumer only
+};
+
+#endif // SV_FRAME_SCHEDULER_HPP
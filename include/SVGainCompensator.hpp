@@ -38,6 +38,13 @@ public:
     void recompute(const std::vector<cv::cuda::GpuMat>& images,
                    const std::vector<cv::Point>& corners,
                    const std::vector<cv::cuda::GpuMat>& masks);
+
+    /* images are already compensated with the current gains, the estimated gains are applied on top of them */
+    void update(const std::vector<cv::cuda::GpuMat>& images,
+                const std::vector<cv::Point>& corners,
+                const std::vector<cv::cuda::GpuMat>& masks);
+
+    double getGain(const int idx) const {return gains(idx, 0);}
 };
 
 
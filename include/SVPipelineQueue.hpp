@@ -0,0 +1,202 @@
+#ifndef SV_PIPELINE_QUEUE_HPP
+#define SV_PIPELINE_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free single-producer / single-consumer queue between pipeline stages
+ *
+ * Slots are preallocated and filled in place:
+ * - The producer fills writeSlot() and calls push()
+ * - The consumer reads readSlot() and calls pop() when done with it
+ *
+ * Unlike SVFrameMailbox no frame is overwritten: a full queue makes the
+ * producer wait (back-pressure), so the depth bounds the latency the queue
+ * can add. Pushing and popping never lock; the mutex is only taken by a
+ * stage that has to wait and by the side that wakes it.
+ *
+ * Slots are reused, so a T that owns storage (cv::cuda::GpuMat) is
+ * reallocated only when the frame size changes.
+ */
+template <typename T>
+class SVSpscQueue {
+public:
+    explicit SVSpscQueue(size_t depth)
+        : slots(depth > 0 ? depth : 1), head(0), tail(0), waiters(0), closed(false),
+          occupancy_sum(0), occupancy_samples(0) {}
+
+    SVSpscQueue(const SVSpscQueue&) = delete;
+    SVSpscQueue& operator=(const SVSpscQueue&) = delete;
+
+    /**
+     * @brief Free slot to fill (producer thread)
+     * @return nullptr if the queue is full
+     */
+    T* writeSlot() {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) return nullptr;
+        return &slots[t % slots.size()];
+    }
+
+    /**
+     * @brief Hand the filled write slot to the consumer (producer thread)
+     */
+    void push() {
+        const size_t t = tail.load(std::memory_order_relaxed) + 1;
+        tail.store(t, std::memory_order_seq_cst);
+        occupancy_sum.fetch_add(t - head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        occupancy_samples.fetch_add(1, std::memory_order_relaxed);
+        wakeWaiters();
+    }
+
+    /**
+     * @brief Oldest queued item (consumer thread)
+     * @return nullptr if the queue is empty
+     */
+    T* readSlot() {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h) return nullptr;
+        return &slots[h % slots.size()];
+    }
+
+    /**
+     * @brief Release the read slot to the producer (consumer thread)
+     */
+    void pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+        wakeWaiters();
+    }
+
+    /**
+     * @brief Wait until writeSlot() succeeds (producer thread)
+     * @return false on timeout or close()
+     */
+    bool waitWritable(std::chrono::milliseconds timeout) {
+        return waitFor(timeout, [this] {
+            return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_seq_cst) < slots.size();
+        });
+    }
+
+    /**
+     * @brief Wait until readSlot() succeeds (consumer thread)
+     * @return false on timeout or close()
+     */
+    bool waitReadable(std::chrono::milliseconds timeout) {
+        return waitFor(timeout, [this] {
+            return tail.load(std::memory_order_seq_cst) != head.load(std::memory_order_relaxed);
+        });
+    }
+
+    /**
+     * @brief Release both sides from their waits (shutdown)
+     */
+    void close() {
+        closed.store(true, std::memory_order_seq_cst);
+        std::lock_guard<std::mutex> lock(wait_mutex);
+        wait_cond.notify_all();
+    }
+
+    size_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    size_t depth() const { return slots.size(); }
+
+    /**
+     * @brief Mean number of queued items right after a push since the last call, then reset
+     *        (one reader)
+     */
+    float takeMeanOccupancy() {
+        const unsigned long samples = occupancy_samples.exchange(0, std::memory_order_relaxed);
+        const unsigned long sum = occupancy_sum.exchange(0, std::memory_order_relaxed);
+        return samples > 0 ? static_cast<float>(sum) / samples : 0.0f;
+    }
+
+private:
+    template <typename Ready>
+    bool waitFor(std::chrono::milliseconds timeout, Ready ready) {
+        if (ready()) return true;
+
+        // Registered before checking again: a push/pop after the check sees the waiter
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(wait_mutex);
+        const bool result = wait_cond.wait_for(lock, timeout, [&] {
+            return ready() || closed.load(std::memory_order_seq_cst);
+        }) && ready();
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void wakeWaiters() {
+        if (waiters.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(wait_mutex);
+            wait_cond.notify_all();
+        }
+    }
+
+    std::vector<T> slots;
+
+    // Monotonic counters, index = counter % depth; on separate cache lines
+    alignas(64) std::atomic<size_t> head;   // Consumer
+    alignas(64) std::atomic<size_t> tail;   // Producer
+
+    std::atomic<int> waiters;
+    std::atomic<bool> closed;
+    std::mutex wait_mutex;
+    std::condition_variable wait_cond;
+
+    std::atomic<unsigned long> occupancy_sum;
+    std::atomic<unsigned long> occupancy_samples;
+};
+
+/**
+ * @brief Time accounting of one pipeline stage
+ *
+ * Written by the stage thread, read and reset by whoever prints statistics.
+ */
+class SVStageMetrics {
+public:
+    struct Sample {
+        unsigned long frames = 0;
+        float work_ms = 0.0f;          // Per frame: processing
+        float input_wait_ms = 0.0f;    // Per frame: starved, waiting for input
+        float output_wait_ms = 0.0f;   // Per frame: blocked, downstream queue full
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    SVStageMetrics() : frames(0), work_ns(0), input_wait_ns(0), output_wait_ns(0) {}
+
+    void addWork(Clock::duration d) { work_ns.fetch_add(toNs(d), std::memory_order_relaxed); }
+    void addInputWait(Clock::duration d) { input_wait_ns.fetch_add(toNs(d), std::memory_order_relaxed); }
+    void addOutputWait(Clock::duration d) { output_wait_ns.fetch_add(toNs(d), std::memory_order_relaxed); }
+    void addFrame() { frames.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Per-frame averages since the last call, then reset
+     */
+    Sample take() {
+        Sample sample;
+        sample.frames = frames.exchange(0, std::memory_order_relaxed);
+        const float scale = sample.frames > 0 ? 1e-6f / sample.frames : 0.0f;
+        sample.work_ms = work_ns.exchange(0, std::memory_order_relaxed) * scale;
+        sample.input_wait_ms = input_wait_ns.exchange(0, std::memory_order_relaxed) * scale;
+        sample.output_wait_ms = output_wait_ns.exchange(0, std::memory_order_relaxed) * scale;
+        return sample;
+    }
+
+private:
+    static uint64_t toNs(Clock::duration d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    std::atomic<unsigned long> frames;
+    std::atomic<uint64_t> work_ns;
+    std::atomic<uint64_t> input_wait_ns;
+    std::atomic<uint64_t> output_wait_ns;
+};
+
+#endif // SV_PIPELINE_QUEUE_HPP
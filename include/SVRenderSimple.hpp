@@ -5,11 +5,17 @@
 #include "Bowl.hpp"
 #include "OGLShader.hpp"
 #include "Model.hpp"
+#include <opencv2/core.hpp>
 #include <opencv2/core/cuda.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <GLFW/glfw3.h>
+#include <EGL/egl.h>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 
 /**
@@ -33,6 +39,80 @@ struct Camera {
     float getCamZoom() const { return zoom; }
 };
 
+/**
+ * @brief Input of one rendered frame
+ * 
+ * The stitched path only uses the panorama; direct projection only
+ * uses the raw camera images and their gains.
+ */
+struct SVRenderFrame {
+    cv::cuda::GpuMat stitched;                              // Stitched panorama (BGR)
+    std::array<cv::cuda::GpuMat, NUM_CAMERAS> cameras;      // Raw camera images (BGR)
+    std::array<float, NUM_CAMERAS> gains;                   // Exposure gain per camera
+};
+
+/**
+ * @brief Receiver of asynchronously read back frames
+ *
+ * Called on the render thread with a BGRA image that wraps the mapped pack
+ * buffer: rows are in OpenGL order (bottom row first) and the data is only
+ * valid during the call. Copy out and return quickly.
+ */
+using SVReadbackCallback = std::function<void(const cv::Mat& bgra, unsigned long frame_number)>;
+
+/**
+ * @brief Runtime bowl shape, applied in the bowl vertex shader
+ *
+ * Units are bowl mesh units (before the bowl model scale).
+ */
+struct BowlShape {
+    float a = 0.4f;
+    float b = 0.4f;
+    float c = 0.2f;
+    float disk_radius = 0.4f;            // Flat floor radius (paraboloid starts here)
+    float outer_radius = 0.55f;          // Rim radius
+};
+
+/**
+ * @brief Compact bowl vertex (RENDER_COMPACT_VERTICES)
+ */
+struct BowlPackedVertex {
+    int16_t position[4];                 // snorm16, BowlLod::position_dequant; w unused
+    uint16_t texcoords[2];               // unorm16 of (u, v) / Bowl::uv_scale
+};
+
+/**
+ * @brief GPU buffers of one bowl level of detail
+ */
+struct BowlLod {
+    std::vector<float> vertices;         // Interleaved (x, y, z, u, v), kept only for direct projection
+    size_t vertex_count = 0;
+    size_t index_count = 0;
+    std::vector<BowlIndexChunk> chunks;  // 16-bit index ranges, each with its base vertex
+    float acmr = 0.0f;                   // Simulated vertex cache misses per triangle
+    float max_edge = 0.0f;               // Longest edge in bowl units (before model scale)
+    PositionDequant position_dequant;    // Compact vertices only
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+    unsigned int proj_VBO = 0;           // Direct projection texcoords + weights per vertex
+};
+
+/**
+ * @brief Uniform locations set every frame, resolved once after linking
+ */
+struct RenderUniforms {
+    GLint bowl_model = -1;
+    GLint bowl_shape = -1;
+    GLint bowl_extent = -1;
+    GLint bowl_grid = -1;
+    GLint direct_model = -1;
+    GLint direct_gains = -1;
+    GLint direct_position_scale = -1;
+    GLint direct_position_offset = -1;
+    GLint car_model = -1;
+};
+
 /**
  * @brief Simplified OpenGL Renderer (No mouse controls)
  * 
@@ -40,19 +120,23 @@ struct Camera {
  * with optional 3D car model overlay.
  * 
  * Features:
- * - Spherical/paraboloid bowl geometry
- * - Texture mapping from stitched output
+ * - Spherical/paraboloid bowl geometry with view-dependent level of detail
+ * - Texture mapping from stitched output, or direct projection of the
+ *   raw cameras (per-vertex camera texcoords and blend weights)
  * - 3D car model rendering
  * - Fixed camera position (no user controls)
+ * - Headless mode: EGL pbuffer/surfaceless context rendering into an FBO
+ *   (works with Mesa llvmpipe, no display server needed)
  */
 class SVRenderSimple {
 public:
     /**
      * @brief Constructor
-     * @param width Window width
-     * @param height Window height
+     * @param width Window (or offscreen framebuffer) width
+     * @param height Window (or offscreen framebuffer) height
+     * @param headless Render offscreen through EGL instead of a GLFW window
      */
-    SVRenderSimple(int width, int height);
+    SVRenderSimple(int width, int height, bool headless = false);
     ~SVRenderSimple();
     
     /**
@@ -70,12 +154,112 @@ public:
               const std::string& car_vert_shader,
               const std::string& car_frag_shader);
     
+    /**
+     * @brief Switch the bowl to direct projection of the raw cameras
+     * @param projections Per-vertex camera texcoords and weights of every LOD
+     *        (12 floats per bowl vertex, see SVStitcherSimple::computeBowlProjection)
+     * @param vert_shader Direct projection vertex shader path
+     * @param frag_shader Direct projection fragment shader path
+     * @return true if successful
+     */
+    bool setupDirectProjection(const std::vector<std::vector<float>>& projections,
+                               const std::string& vert_shader,
+                               const std::string& frag_shader);
+    
+    /**
+     * @brief Switch to the multi-view layout (see RENDER_MULTIVIEW)
+     *
+     * The 3D and top-down views share the bowl/car buffers and the texture
+     * upload: every mesh is drawn once, instanced per view. Camera tiles
+     * show layers of the camera texture array and need direct projection;
+     * without it only the two bowl views are shown side by side.
+     * @param tile_vert Camera tile vertex shader path
+     * @param tile_frag Camera tile fragment shader path
+     * @return true if successful
+     */
+    bool setupMultiView(const std::string& tile_vert, const std::string& tile_frag);
+    
+    /**
+     * @brief Reshape the bowl (takes effect on the next frame, no mesh upload)
+     *
+     * Thread-safe. Only the stitched-texture path follows the shape; direct
+     * projection keeps the generated mesh its camera texcoords were computed for.
+     * @param shape New shape (a, b, c > 0, hole < disk_radius < outer_radius)
+     * @return true if the shape is valid and was applied
+     */
+    bool setBowlShape(const BowlShape& shape);
+    
+    /**
+     * @brief Current bowl shape
+     */
+    BowlShape getBowlShape() const;
+    
+    /**
+     * @brief Move the bowl wall to the nearest obstacle
+     *
+     * Sets the disk radius to the distance (bowl units), clamped to
+     * [BOWL_MIN_DISK_RADIUS, BOWL_MAX_DISK_FRACTION * outer radius].
+     * @param distance Distance of the nearest obstacle from the bowl center
+     */
+    void setObstacleDistance(float distance);
+    
+    /**
+     * @brief Number of bowl levels of detail
+     */
+    int getBowlLodCount() const { return static_cast<int>(bowl_lods.size()); }
+    
+    /**
+     * @brief Interleaved bowl vertices (x, y, z, u, v) of a level of detail
+     */
+    const std::vector<float>& getBowlVertices(const int lod) const { return bowl_lods[lod].vertices; }
+    
+    /**
+     * @brief Bowl LOD drawn by the last render() call
+     */
+    int getLastBowlLod() const { return last_bowl_lod.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Bowl vertices drawn by the last render() call
+     */
+    size_t getLastBowlVertexCount() const { return last_bowl_vertices.load(std::memory_order_relaxed); }
+    
+    static constexpr int BOWL_VERTEX_STRIDE = 5;
+    static constexpr int BOWL_UV_OFFSET = 3;
+    
     /**
      * @brief Render a frame
-     * @param stitched_texture Stitched surround view texture (GPU)
+     * @param frame Stitched texture or camera images (GPU)
+     * @param upload false to redraw with the textures already uploaded
+     * @return true if successful
+     */
+    bool render(const SVRenderFrame& frame, bool upload = true);
+    
+    /**
+     * @brief Make the GL context current on the calling thread
+     * 
+     * init() leaves the context current on the thread that created it;
+     * call detachContext() there before rendering from another thread.
+     * @param swap_interval Buffer swaps to wait per frame (1 = vsync)
      * @return true if successful
      */
-    bool render(const cv::cuda::GpuMat& stitched_texture);
+    bool attachContext(int swap_interval = 1);
+    
+    /**
+     * @brief Release the GL context from the calling thread
+     */
+    void detachContext();
+    
+    /**
+     * @brief Process window events (must run on the thread that called init())
+     */
+    void pollEvents();
+    
+    /**
+     * @brief Sleep until window events arrive or the timeout passes, then process them
+     *        (same thread as pollEvents(); headless just sleeps)
+     * @param timeout_ms Maximum wait
+     */
+    void waitEvents(int timeout_ms);
     
     /**
      * @brief Check if window should close
@@ -83,12 +267,131 @@ public:
      */
     bool shouldClose() const;
     
+    /**
+     * @brief Read back the last rendered frame (blocking)
+     * @param frame Output BGR image (top row first)
+     * @return true if successful
+     */
+    bool readFrame(cv::Mat& frame);
+    
+    /**
+     * @brief Deliver every rendered frame without blocking the render loop
+     *
+     * Each render() reads the frame into the next buffer of a pack PBO ring
+     * and hands finished buffers (fence signaled) to the callback one or two
+     * frames later. Set before rendering starts; an empty callback disables it.
+     * @param callback Receiver, see SVReadbackCallback
+     */
+    void setReadbackCallback(SVReadbackCallback callback);
+    
+    /**
+     * @brief Frames not read back because every pack buffer was still in flight
+     */
+    unsigned long getReadbackDropCount() const { return readback_drops.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Render-thread time spent in the last readback (map + callback)
+     * @return Milliseconds
+     */
+    float getLastReadbackTimeMs() const { return last_readback_ms.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Write the last rendered frame to an image file
+     * @param path Output file path (format from extension)
+     * @return true if successful
+     */
+    bool saveFrame(const std::string& path);
+    
+    /**
+     * @brief Duration of the last render() call
+     * @return Milliseconds (includes glFinish in headless mode)
+     */
+    float getLastRenderTimeMs() const { return last_render_ms.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief CPU time spent in the last texture upload
+     * @return Milliseconds
+     */
+    float getLastUploadTimeMs() const { return last_upload_ms.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Uploads skipped because every PBO was still in use by the GPU
+     */
+    unsigned long getUploadStallCount() const { return upload_stalls.load(std::memory_order_relaxed); }
+    
+    bool isHeadless() const { return headless; }
+    
 private:
     /**
-     * @brief Setup bowl geometry
+     * @brief Create GLFW window and OpenGL context
+     * @return true if successful
+     */
+    bool initWindow();
+    
+    /**
+     * @brief Create EGL context and offscreen framebuffer (headless mode)
+     * @return true if successful
+     */
+    bool initHeadless();
+    
+    /**
+     * @brief Destroy the EGL surface and context and release the display (headless mode)
+     */
+    void releaseHeadless();
+    
+    /**
+     * @brief Create the view/projection uniform buffer shared by all programs
+     */
+    void setupCameraBuffer();
+    
+    /**
+     * @brief Write the matrices and tiles of all views into the camera block
+     */
+    void updateCameraBlock();
+    
+    /**
+     * @brief Attach a program to the shared camera block
+     * @param shader Linked program with a "Camera" uniform block
+     */
+    void bindCameraBlock(const OGLShader& shader) const;
+    
+    /**
+     * @brief Defines all programs are built with (vertex layout, view count, bowl UV_SCALE)
+     */
+    static std::string shaderDefines();
+    
+    /**
+     * @brief Camera block and viewPosition() prelude of the vertex shaders using the camera block
+     * @param vert_shader Vertex shader path, the prelude (cameraviewvert.glsl) is read from its directory
+     */
+    static std::string cameraPreludePath(const std::string& vert_shader);
+    
+    /**
+     * @brief Setup bowl geometry (all levels of detail)
      */
     void setupBowl();
     
+    /**
+     * @brief Create the VAO/VBO/EBO of one bowl LOD
+     * @param lod LOD to fill (vertex and index counts are set here)
+     * @param vertices Interleaved (x, y, z, u, v)
+     * @param vertex_floats Number of floats in vertices
+     * @param indices 16-bit triangle strips separated by Bowl::strip_restart
+     * @param index_count Number of indices
+     * @param chunks Base vertex and index range of each chunk
+     * @param chunk_count Number of chunks
+     */
+    void uploadBowlLod(BowlLod& lod, const float* vertices, size_t vertex_floats,
+                       const uint16_t* indices, size_t index_count,
+                       const BowlIndexChunk* chunks, size_t chunk_count);
+    
+    /**
+     * @brief Pick the coarsest bowl LOD whose edges stay below BOWL_LOD_MAX_EDGE_PIXELS
+     * @param bowl_model Bowl model matrix
+     * @return LOD index (0 = finest)
+     */
+    int selectBowlLod(const glm::mat4& bowl_model) const;
+    
     /**
      * @brief Setup car model
      * @param model_path Path to model file
@@ -100,31 +403,110 @@ private:
                        const std::string& frag_shader);
     
     /**
-     * @brief Upload texture from GPU to OpenGL
+     * @brief Allocate immutable texture storage and the PBO ring
+     */
+    void setupTextureUpload();
+    
+    /**
+     * @brief Upload texture from GPU to OpenGL through the next free PBO
      * @param frame GPU frame data
      */
     void textureUpload(const cv::cuda::GpuMat& frame);
     
-    // Bowl geometry data (ADD THESE)
-    std::vector<float> bowl_vertices;
-    std::vector<unsigned int> bowl_indices;
-    size_t bowl_index_count;
+    /**
+     * @brief Upload all camera images into the camera texture array
+     * @param cameras GPU camera frames (CAMERA_WIDTH x CAMERA_HEIGHT, BGR)
+     */
+    void cameraUpload(const std::array<cv::cuda::GpuMat, NUM_CAMERAS>& cameras);
+    
+    /**
+     * @brief Bind the next PBO of the ring and return its write pointer
+     * @return nullptr if the GPU still uses it (upload skipped)
+     */
+    void* beginUpload();
+    
+    /**
+     * @brief Unmap the PBO (texture update from the PBO follows)
+     */
+    void endUpload();
+    
+    /**
+     * @brief Fence the PBO after the texture update and move to the next one
+     */
+    void fenceUpload();
+    
+    /**
+     * @brief Hand finished readbacks to the callback, then queue the current frame
+     *
+     * Must run before the buffer swap (reads the back buffer or the FBO).
+     */
+    void readbackFrame();
+    
+    /**
+     * @brief Release the pack PBO ring and its fences
+     */
+    void releaseReadback();
+    
+    /**
+     * @brief Resolve a GL entry point from the active context (GLFW or EGL)
+     */
+    void* getProcAddress(const char* name) const;
+    
+    /**
+     * @brief Whether the current context provides a feature, from its version or extension list
+     *        (getProcAddress() alone also resolves entry points the context does not support)
+     * @param major, minor GL version that made the feature core
+     * @param extension Extension providing it on older contexts
+     */
+    bool hasGLFeature(int major, int minor, const char* extension) const;
+    
     // Window
     GLFWwindow* window;
     int screen_width;
     int screen_height;
     float aspect_ratio;
     
+    // Headless (EGL + FBO)
+    bool headless;
+    EGLDisplay egl_display;
+    EGLContext egl_context;
+    EGLSurface egl_surface;
+    unsigned int fbo_id;
+    unsigned int fbo_color_rb;
+    unsigned int fbo_depth_rb;
+    
+    // Timing (written by the render thread, read for stats)
+    std::atomic<float> last_render_ms;
+    std::atomic<float> last_upload_ms;
+    std::atomic<int> last_bowl_lod;
+    std::atomic<size_t> last_bowl_vertices;
+    
     // Camera (fixed position, no controls)
     Camera camera;
+    unsigned int camera_ubo;             // Per-view matrices and tiles (std140), RENDER_CAMERA_BINDING
+    RenderUniforms uniforms;
+    
+    // Multi-view: view 0 is the 3D view, view 1 the top-down view
+    int view_count;
+    bool camera_tiles;                   // Raw camera tiles below the bowl views
+    OGLShader tile_shader;
+    unsigned int tile_vao;               // Empty, the tile quad comes from gl_VertexID
     
     // Bowl rendering
     ConfigBowl bowl_config;
     Bowl bowl_geometry;
     OGLShader bowl_shader;
-    unsigned int bowl_VAO;
-    unsigned int bowl_VBO;
-    unsigned int bowl_EBO;
+    std::vector<BowlLod> bowl_lods;      // Finest first
+    
+    // Dynamic bowl shape (set from any thread, read by the render thread)
+    mutable std::mutex bowl_shape_mutex;
+    BowlShape bowl_shape;
+    float bowl_floor_y;                  // Floor height of the generated mesh, kept when reshaping
+    
+    // Direct projection
+    bool direct_projection;
+    OGLShader direct_shader;
+    unsigned int camera_texture_id;      // GL_TEXTURE_2D_ARRAY, one layer per camera
     
     // Car model rendering
     std::unique_ptr<Model> car_model;
@@ -133,7 +515,26 @@ private:
     
     // Texture handling
     unsigned int texture_id;
-    unsigned int pbo_id;  // Pixel Buffer Object for fast upload
+    
+    // PBO ring for streaming upload, one fence per buffer
+    unsigned int pbo_ids[RENDER_PBO_COUNT];
+    void* pbo_ptrs[RENDER_PBO_COUNT];   // Persistent mappings (nullptr if unsupported)
+    GLsync pbo_fences[RENDER_PBO_COUNT];
+    size_t pbo_size;
+    int pbo_index;
+    bool pbo_persistent;
+    std::atomic<unsigned long> upload_stalls;
+    
+    // Asynchronous readback: pack PBO ring, filled at readback_head, delivered oldest first
+    SVReadbackCallback readback_callback;
+    unsigned int readback_pbos[RENDER_READBACK_PBO_COUNT];
+    GLsync readback_fences[RENDER_READBACK_PBO_COUNT];
+    unsigned long readback_numbers[RENDER_READBACK_PBO_COUNT];
+    int readback_head;
+    int readback_pending;
+    unsigned long readback_counter;
+    std::atomic<unsigned long> readback_drops;
+    std::atomic<float> last_readback_ms;
     
     bool is_init;
 };
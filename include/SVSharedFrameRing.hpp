@@ -0,0 +1,229 @@
+#ifndef SV_SHARED_FRAME_RING_HPP
+#define SV_SHARED_FRAME_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Frame ring in POSIX shared memory, shared by one publisher and any number of readers
+ *
+ * Layout of the shared memory object (all offsets from its start):
+ * - SVShmRingHeader
+ * - slot_count x SVShmSlotHeader
+ * - slot_count frame buffers of frame_bytes each, page aligned (slot_offset + i * slot_pitch)
+ *
+ * Frame i (sequence numbers start at 1) goes to slot (i - 1) % slot_count.
+ * Every slot carries a seqlock: odd while the publisher writes it, bumped
+ * to the next even value when the frame is complete. Readers never take a
+ * lock and use the frame in place; they check the seqlock afterwards, and
+ * a changed value means the publisher lapped them and the data is torn.
+ * With N slots a reader has N - 1 frame periods to finish with a frame.
+ *
+ * Timestamps are CLOCK_MONOTONIC nanoseconds (std::chrono::steady_clock on
+ * Linux), comparable between processes on the same machine.
+ *
+ * Only depends on POSIX (shm_open, mmap, futex); readers link svshmring.
+ */
+
+#define SV_SHM_RING_VERSION 1
+
+/**
+ * @brief Ring description, written once by the publisher before ready is set
+ */
+struct SVShmRingHeader {
+    char magic[8];                          // "SVSHMRNG"
+    uint32_t version;                       // SV_SHM_RING_VERSION
+    uint32_t slot_count;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;                      // Interleaved 8-bit channels (3 = BGR)
+    uint32_t stride;                        // Bytes per row
+    uint64_t frame_bytes;
+    uint64_t slot_offset;                   // First frame buffer
+    uint64_t slot_pitch;                    // Distance between frame buffers
+    std::atomic<uint32_t> ready;            // Layout above is valid
+    std::atomic<uint32_t> closed;           // Publisher has shut down, reopen to follow a new one
+    std::atomic<uint64_t> latest;           // Sequence of the newest complete frame (0 = none yet)
+    std::atomic<uint32_t> frame_counter;    // Futex word, bumped on every publish
+    std::atomic<uint32_t> waiters;          // Readers blocked in waitForFrame()
+};
+
+/**
+ * @brief Per-slot seqlock and frame metadata
+ */
+struct SVShmSlotHeader {
+    std::atomic<uint32_t> seqlock;          // Odd while being written
+    uint32_t reserved;
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> capture_ns;       // Camera frames captured
+    std::atomic<uint64_t> publish_ns;       // Frame complete in the ring
+};
+
+/**
+ * @brief Monotonic clock in nanoseconds, the time base of the ring timestamps
+ */
+uint64_t svShmNowNs();
+
+/**
+ * @brief Writer side of the ring (one per ring)
+ *
+ * Frames are written in place: beginWrite() returns the slot buffer,
+ * endWrite() publishes it. The object is unlinked and recreated on
+ * init(), so a stale ring of another size never survives a restart.
+ */
+class SVShmFramePublisher {
+public:
+    SVShmFramePublisher();
+    ~SVShmFramePublisher();
+
+    SVShmFramePublisher(const SVShmFramePublisher&) = delete;
+    SVShmFramePublisher& operator=(const SVShmFramePublisher&) = delete;
+
+    /**
+     * @brief Create the shared memory object and lay out the ring
+     * @param name POSIX shm name ("/sv_stitched")
+     * @param width Frame width in pixels
+     * @param height Frame height in pixels
+     * @param channels Interleaved 8-bit channels per pixel
+     * @param slot_count Frames kept in the ring (at least 2)
+     * @return true if successful
+     */
+    bool init(const std::string& name, uint32_t width, uint32_t height, uint32_t channels,
+              uint32_t slot_count);
+
+    /**
+     * @brief Start writing the next frame
+     * @return Slot buffer (frame_bytes, rows of getStride() bytes), valid until endWrite()
+     */
+    uint8_t* beginWrite();
+
+    /**
+     * @brief Publish the frame written since beginWrite() and wake waiting readers
+     * @param capture_ns Capture time of the source frames (svShmNowNs() time base)
+     * @return Sequence number of the frame
+     */
+    uint64_t endWrite(uint64_t capture_ns);
+
+    /**
+     * @brief Mark the ring closed, unmap and unlink it
+     */
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+    uint32_t getStride() const { return header ? header->stride : 0; }
+
+    /**
+     * @brief Frame buffers of all slots (one contiguous range, e.g. for cudaHostRegister)
+     */
+    uint8_t* getFrameData() const;
+    size_t getFrameDataSize() const;
+
+private:
+    std::string shm_name;
+    void* mapped;
+    size_t mapped_size;
+    SVShmRingHeader* header;
+    SVShmSlotHeader* slots;
+    uint64_t next_sequence;
+    bool writing;
+};
+
+/**
+ * @brief Reader side of the ring (any number, in any process)
+ */
+class SVShmFrameReader {
+public:
+    /**
+     * @brief Frame used in place inside the ring
+     */
+    struct View {
+        const uint8_t* data = nullptr;
+        uint64_t sequence = 0;
+        uint64_t capture_ns = 0;
+        uint64_t publish_ns = 0;
+        uint32_t slot = 0;
+        uint32_t seqlock = 0;
+    };
+
+    SVShmFrameReader();
+    ~SVShmFrameReader();
+
+    SVShmFrameReader(const SVShmFrameReader&) = delete;
+    SVShmFrameReader& operator=(const SVShmFrameReader&) = delete;
+
+    /**
+     * @brief Map an existing ring (frames are only read; the mapping is writable
+     *        because waitForFrame() registers itself in the header)
+     * @param name POSIX shm name used by the publisher
+     * @return false if it does not exist (yet) or is not a valid ring
+     */
+    bool open(const std::string& name);
+
+    void close();
+
+    /**
+     * @brief Newest complete frame, if newer than the last one acquired
+     * @param view Filled with the frame; check isValid() after using the data
+     * @return false if there is no new frame, or its slot is already being
+     *         overwritten (waitForPublish() before trying again)
+     */
+    bool acquireLatest(View& view);
+
+    /**
+     * @brief Check that the publisher did not overwrite the frame while it was used
+     */
+    bool isValid(const View& view) const;
+
+    /**
+     * @brief Wait until a frame newer than the last acquired one is published
+     * @param timeout_ms Maximum wait
+     * @return true if a new frame is available
+     */
+    bool waitForFrame(int timeout_ms);
+
+    /**
+     * @brief Wait until the publisher completes a frame after the last acquireLatest() call
+     *
+     * A frame acquireLatest() found overwritten is complete again at the
+     * next publish, waitForFrame() would return at once for it.
+     * @param timeout_ms Maximum wait
+     * @return true if a frame was published since
+     */
+    bool waitForPublish(int timeout_ms);
+
+    /**
+     * @brief Publisher shut down; close() and open() again to follow a restarted one
+     */
+    bool isPublisherClosed() const;
+
+    bool isOpen() const { return header != nullptr; }
+    const SVShmRingHeader* getHeader() const { return header; }
+
+    /**
+     * @brief Frame buffers of all slots (one contiguous range, e.g. for cudaHostRegister)
+     */
+    uint8_t* getFrameData() const;
+    size_t getFrameDataSize() const;
+
+    // Frames published but never acquired because newer ones arrived first
+    uint64_t getSkippedCount() const { return skipped_frames; }
+
+private:
+    void* mapped;
+    size_t mapped_size;
+    SVShmRingHeader* header;
+    SVShmSlotHeader* slots;
+    uint64_t last_sequence;
+    uint32_t acquire_counter;               // frame_counter seen by the last acquireLatest()
+    uint64_t skipped_frames;
+
+    /**
+     * @brief Block on the frame_counter futex until a new frame (or publish) or the timeout
+     * @param any_publish Return on any publish since acquireLatest(), not only on a new latest
+     */
+    bool wait(int timeout_ms, bool any_publish);
+};
+
+#endif // SV_SHARED_FRAME_RING_HPP
@@ -0,0 +1,87 @@
+#ifndef SV_SHARED_MEMORY_CAMERA_HPP
+#define SV_SHARED_MEMORY_CAMERA_HPP
+
+#include "SVEthernetCamera.hpp"
+#include "SVSharedFrameRing.hpp"
+#include <array>
+#include <string>
+
+/**
+ * @brief Camera frames decoded by another process, read from shared memory
+ *
+ * Drop-in MultiCameraSource for setups where a perception process already
+ * decodes the camera streams: instead of a second RTP receive + decode per
+ * camera, it attaches to one shared-memory ring per camera (prefix + index,
+ * e.g. /sv_cam0../sv_cam3) written by the producer with SVShmFramePublisher.
+ *
+ * Producer contract: BGR or BGRA 8-bit frames, capture_ns in CLOCK_MONOTONIC.
+ * Frames are uploaded to the GPU straight from the ring slots (page-locked
+ * when CUDA accepts the mapping); a frame the producer overwrote during the
+ * upload is discarded and the next one taken. A restarted producer is
+ * followed by reopening its ring. No Ethernet camera sources or decoder
+ * CUDA streams are created.
+ */
+class SharedMemoryCameraSource : public MultiCameraSource {
+public:
+    /**
+     * @param ringPrefix POSIX shm name prefix, the camera index is appended
+     */
+    explicit SharedMemoryCameraSource(const std::string& ringPrefix);
+    ~SharedMemoryCameraSource() override;
+
+    int init(const std::string& param_filepath, const cv::Size& calibSize,
+             const cv::Size& undistSize, const bool useUndist = false) override;
+
+    /**
+     * @brief Attach to the camera rings, waiting up to SHM_INPUT_TIMEOUT_MS for the producer
+     */
+    bool startStream() override;
+    bool stopStream() override;
+
+    /**
+     * @brief Newest frame of every camera (waits up to SHM_INPUT_TIMEOUT_MS per camera)
+     */
+    bool capture(std::array<Frame, CAM_NUMS>& frames) override;
+
+    /**
+     * @brief Only recorded: the producer decides the frame size
+     */
+    bool setFrameSize(const cv::Size& size) override;
+
+    void close() override;
+
+    // Frames overwritten by the producer while being uploaded
+    unsigned long getTornCount() const { return tornFrames; }
+
+    // Capture time spread of the last complete frame set
+    float getLastSkewMs() const { return lastSkewNs / 1e6f; }
+
+    // Frames the producer published that were never consumed (we were slower)
+    uint64_t getSkippedCount() const;
+
+private:
+    /**
+     * @brief Open the ring of one camera and page-lock its slots
+     */
+    bool openRing(size_t idx);
+    void closeRing(size_t idx);
+
+    /**
+     * @brief Upload the newest frame of one camera into rawFrames[idx]
+     */
+    bool captureCamera(size_t idx);
+
+    std::string ringPrefix;
+    std::array<SVShmFrameReader, CAM_NUMS> readers;
+    std::array<bool, CAM_NUMS> pinned;
+
+    // Reused between captures
+    std::array<cv::cuda::GpuMat, CAM_NUMS> rawFrames;
+    std::array<cv::cuda::GpuMat, CAM_NUMS> uploadFrames;    // BGRA before conversion
+    std::array<uint64_t, CAM_NUMS> captureNs;
+
+    unsigned long tornFrames;
+    uint64_t lastSkewNs;
+};
+
+#endif // SV_SHARED_MEMORY_CAMERA_HPP
@@ -47,10 +47,44 @@ public:
                 cv::cuda::GpuMat& output);
     
     /**
-     * @brief Recompute gain compensation (call periodically)
-     * @param frames Vector of 4 camera frames
+     * @brief Recompute gain compensation (call periodically, after stitch())
+     * 
+     * Reads the overlap statistics from the blender pyramid level
+     * GAIN_STATS_LEVEL built by the last stitch(), no extra warp pass.
      */
-    void recomputeGain(const std::vector<cv::cuda::GpuMat>& frames);
+    void recomputeGain();
+    
+    /**
+     * @brief Measure mean luma of every camera (before gain compensation)
+     * 
+     * Uses the blender pyramid level GAIN_STATS_LEVEL of the last stitch(),
+     * divided by the current gain so gain updates do not show up as drift.
+     * @param lumas Output mean luma per camera
+     * @return true if statistics are available
+     */
+    bool measureLuma(std::vector<double>& lumas);
+    
+    /**
+     * @brief Project bowl texture coordinates back into the raw cameras
+     * 
+     * Follows every vertex UV through the output crop, the spherical warp
+     * and K/R of each camera. Per vertex the output holds 4 camera
+     * texcoords (u0 v0 .. u3 v3, normalized, top row = 0) followed by
+     * 4 blend weights; only the two largest weights are kept and they
+     * sum to 1 (all 0 where no camera sees the vertex).
+     * @param vertices Interleaved bowl vertex data
+     * @param stride Floats per vertex
+     * @param uv_offset Offset of the stitched texcoord (u, v) in a vertex
+     * @param projection Output, 12 floats per vertex
+     * @return true if successful (requires 4 cameras)
+     */
+    bool computeBowlProjection(const std::vector<float>& vertices, const int stride,
+                               const int uv_offset, std::vector<float>& projection) const;
+    
+    /**
+     * @brief Current gain of a camera
+     */
+    double getGain(const int idx) const { return gain_comp ? gain_comp->getGain(idx) : 1.0; }
     
     /**
      * @brief Check if stitcher is initialized
@@ -105,10 +139,12 @@ private:
     
     // Gain compensation
     std::shared_ptr<SVGainCompensator> gain_comp;
+    std::vector<int> luma_pixel_counts;         // Mask pixels per camera at stats level
     
     // Output cropping
     cv::cuda::GpuMat crop_warp_x;              // Crop X map
     cv::cuda::GpuMat crop_warp_y;              // Crop Y map
+    cv::Mat crop_transform;                    // Panorama -> output homography (empty if resized)
     cv::Size output_size;                       // Final output size
     
     // State
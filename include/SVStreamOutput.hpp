@@ -0,0 +1,133 @@
+#ifndef SV_STREAM_OUTPUT_HPP
+#define SV_STREAM_OUTPUT_HPP
+
+#include "SVConfig.hpp"
+#include <opencv2/core.hpp>
+#include <gst/gst.h>
+#include <gst/app/gstappsrc.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief H.264 output stream of rendered or stitched frames
+ *
+ * Frames are copied into a GStreamer appsrc and encoded on GStreamer's
+ * streaming threads, so push() never waits for the encoder:
+ *
+ *   appsrc ! videoconvert ! <encoder> ! h264parse ! rtph264pay ! udpsink
+ *   appsrc ! videoconvert ! <encoder> ! h264parse ! <muxer> ! filesink
+ *
+ * The encoder is picked at runtime: the Jetson (nvv4l2h264enc) or desktop
+ * (nvh264enc) NVIDIA encoder when installed, x264enc otherwise.
+ * Frames waiting for the encoder are bounded by a buffer pool of
+ * STREAM_QUEUE_DEPTH buffers; when all are in flight the new frame is
+ * dropped and counted.
+ *
+ * Encode latency is measured per frame from push() until the encoded
+ * frame leaves the encoder (probe on the encoder source pad).
+ */
+class SVStreamOutput {
+public:
+    SVStreamOutput();
+    ~SVStreamOutput();
+
+    SVStreamOutput(const SVStreamOutput&) = delete;
+    SVStreamOutput& operator=(const SVStreamOutput&) = delete;
+
+    /**
+     * @brief Build and start the pipeline
+     * @param size Frame size
+     * @param channels 4 for BGRA frames, 3 for BGR
+     * @param fps Nominal frame rate (caps and encoder keyframe interval)
+     * @param target "udp://host:port" for RTP/UDP, otherwise a file path
+     *        (.mp4 and .mkv are muxed, anything else is a raw H.264 byte stream)
+     * @return true if the pipeline is playing
+     */
+    bool init(const cv::Size& size, int channels, int fps, const std::string& target);
+
+    /**
+     * @brief Queue a frame for encoding (thread-safe, never blocks)
+     * @param frame CV_8UC4 or CV_8UC3 image of the init() size and channels
+     * @param bottom_up Rows are in OpenGL order (bottom row first) and are flipped while copying
+     * @return false if the frame was dropped (queue full, wrong format or pipeline error)
+     */
+    bool push(const cv::Mat& frame, bool bottom_up = false);
+
+    /**
+     * @brief Finish the stream (EOS, so file muxers can write their index) and release the pipeline
+     */
+    void close();
+
+    bool isOpen() const { return pipeline != nullptr; }
+    const std::string& getEncoderName() const { return encoder_name; }
+
+    unsigned long getPushedCount() const { return pushed_frames.load(std::memory_order_relaxed); }
+    unsigned long getDroppedCount() const { return dropped_frames.load(std::memory_order_relaxed); }
+    unsigned long getEncodedCount() const { return encoded_frames.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Latency of the last encoded frame, push() to encoder output
+     * @return Milliseconds
+     */
+    float getLastEncodeLatencyMs() const { return last_latency_ms.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Mean encode latency over all encoded frames
+     * @return Milliseconds
+     */
+    float getMeanEncodeLatencyMs() const;
+
+private:
+    /**
+     * @brief Select the H.264 encoder element available on this system
+     * @return Encoder description for gst_parse_launch, named "enc"
+     */
+    std::string selectEncoder();
+
+    std::string createPipelineString(const std::string& encoder) const;
+
+    /**
+     * @brief Log and latch pipeline errors posted on the bus
+     * @return false once the pipeline has failed
+     */
+    bool checkBus();
+
+    static GstPadProbeReturn encodedProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data);
+
+    // GStreamer elements
+    GstElement* pipeline;
+    GstElement* appsrc;
+    GstBus* bus;
+    GstBufferPool* pool;
+
+    // Stream configuration
+    cv::Size frame_size;
+    int frame_channels;
+    int frame_rate;
+    std::string target;
+    std::string encoder_name;
+    bool failed;
+
+    // Push time of the frames in flight, looked up by PTS when they leave the encoder
+    struct PendingFrame {
+        GstClockTime pts;
+        std::chrono::steady_clock::time_point pushed;
+    };
+    std::array<PendingFrame, 64> pending;
+    unsigned long pending_head;
+    std::mutex pending_mutex;           // Also orders timestamps and appsrc pushes
+    std::chrono::steady_clock::time_point start_time;
+    GstClockTime last_pts;
+
+    // Statistics
+    std::atomic<unsigned long> pushed_frames;
+    std::atomic<unsigned long> dropped_frames;
+    std::atomic<unsigned long> encoded_frames;
+    std::atomic<float> last_latency_ms;
+    std::atomic<double> total_latency_ms;
+};
+
+#endif // SV_STREAM_OUTPUT_HPP
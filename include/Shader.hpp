@@ -3,6 +3,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <unordered_map>
 
 #include <GLES3/gl32.h>
 #include <EGL/egl.h>
@@ -10,6 +11,34 @@
 #include <glm/glm.hpp>
 
 
+// locations of all active uniforms of a linked program; arrays also under their base name ("a[0]" and "a")
+inline void queryUniformLocations(const GLuint program, std::unordered_map<std::string, GLint>& locations)
+{
+        locations.clear();
+
+        GLint count = 0, max_len = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_len);
+
+        std::string name(max_len > 0 ? max_len : 1, '\0');
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei len = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), &len, &size, &type, &name[0]);
+
+            const std::string uniform(name.data(), len);
+            const GLint location = glGetUniformLocation(program, uniform.c_str());
+            if (location < 0)
+                continue;   // member of a uniform block
+
+            locations[uniform] = location;
+            const auto bracket = uniform.find('[');
+            if (bracket != std::string::npos)
+                locations[uniform.substr(0, bracket)] = location;
+        }
+}
+
 
 class Shader
 {
@@ -41,6 +70,8 @@ public:
             if (shaderprogram == 0)
                 return false;
 
+            queryUniformLocations(shaderprogram, locations);
+
 
             isInit = true;
 
@@ -56,66 +87,77 @@ public:
             return true;
 	}
 	// ------------------------------------------------------------------------
+	// resolved at link time; names that are not active uniforms are looked up once and cached as well
+	GLint getUniformLocation(const std::string& name) const
+	{
+            auto it = locations.find(name);
+            if (it != locations.end())
+                return it->second;
+            const GLint location = glGetUniformLocation(shaderprogram, name.c_str());
+            locations.emplace(name, location);
+            return location;
+	}
+	// ------------------------------------------------------------------------
 	void setBool(const std::string& name, bool value) const
 	{
             if (isInit)
-                glUniform1i(glGetUniformLocation(shaderprogram, name.c_str()), (int)value);
+                glUniform1i(getUniformLocation(name), (int)value);
 	}
 	// ------------------------------------------------------------------------
 	void setInt(const std::string& name, int value) const
 	{
             if (isInit)
-                glUniform1i(glGetUniformLocation(shaderprogram, name.c_str()), value);
+                glUniform1i(getUniformLocation(name), value);
 	}
 	// ------------------------------------------------------------------------
 	void setFloat(const std::string& name, float value) const
 	{
             if (isInit)
-                glUniform1f(glGetUniformLocation(shaderprogram, name.c_str()), value);
+                glUniform1f(getUniformLocation(name), value);
 	}
 
 	// ------------------------------------------------------------------------
 	void setVec2(const std::string& name, const glm::vec2& value) const
 	{
-            glUniform2fv(glGetUniformLocation(shaderprogram, name.c_str()), 1, &value[0]);
+            glUniform2fv(getUniformLocation(name), 1, &value[0]);
 	}
 	// ------------------------------------------------------------------------
 	void setVec2(const std::string& name, float x, float y) const
 	{
-            glUniform2f(glGetUniformLocation(shaderprogram, name.c_str()), x, y);
+            glUniform2f(getUniformLocation(name), x, y);
 	}
 	// ------------------------------------------------------------------------
 	void setVec3(const std::string& name, const glm::vec3& value) const
 	{
-            glUniform3fv(glGetUniformLocation(shaderprogram, name.c_str()), 1, &value[0]);
+            glUniform3fv(getUniformLocation(name), 1, &value[0]);
 	}
 	void setVec3(const std::string& name, float x, float y, float z) const
 	{
-            glUniform3f(glGetUniformLocation(shaderprogram, name.c_str()), x, y, z);
+            glUniform3f(getUniformLocation(name), x, y, z);
 	}
 	// ------------------------------------------------------------------------
 	void setVec4(const std::string& name, const glm::vec4& value) const
 	{
-            glUniform4fv(glGetUniformLocation(shaderprogram, name.c_str()), 1, &value[0]);
+            glUniform4fv(getUniformLocation(name), 1, &value[0]);
 	}
 	void setVec4(const std::string& name, float x, float y, float z, float w)
 	{
-            glUniform4f(glGetUniformLocation(shaderprogram, name.c_str()), x, y, z, w);
+            glUniform4f(getUniformLocation(name), x, y, z, w);
 	}
 	// ------------------------------------------------------------------------
 	void setMat2(const std::string& name, const glm::mat2& mat) const
 	{
-            glUniformMatrix2fv(glGetUniformLocation(shaderprogram, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+            glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 	}
 	// ------------------------------------------------------------------------
 	void setMat3(const std::string& name, const glm::mat3& mat) const
 	{
-            glUniformMatrix3fv(glGetUniformLocation(shaderprogram, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+            glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 	}
 	// ------------------------------------------------------------------------
 	void setMat4(const std::string& name, const glm::mat4& mat) const
 	{
-            glUniformMatrix4fv(glGetUniformLocation(shaderprogram, name.c_str()), 1, GL_FALSE, &mat[0][0]); // &mat[0][0] <-> glm::value_ptr(mat)
+            glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]); // &mat[0][0] <-> glm::value_ptr(mat)
 	}
 
 	GLuint getShaderProgram() const { return shaderprogram; }
@@ -223,5 +265,6 @@ private:
 	GLuint fragmentshader = 0;
 	GLuint geometryshader = 0;
 	GLboolean isInit = false;
+	mutable std::unordered_map<std::string, GLint> locations;
 	static constexpr size_t buff_len = 512;
 };
@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <glm.hpp>
+
+
+/*
+    compact vertex attributes: 16-bit normalized integers, octahedral normals and half floats,
+    unpacked by the vertex fetch (glVertexAttribPointer normalized / GL_HALF_FLOAT)
+*/
+
+
+// position = offset + scale * snorm16 (per mesh)
+struct PositionDequant
+{
+    glm::vec3 scale = glm::vec3(1.f);
+    glm::vec3 offset = glm::vec3(0.f);
+};
+
+// bounding box of count positions (x, y, z at the start of every stride floats), mapped to [-1, 1]
+inline PositionDequant computePositionDequant(const float* data, const size_t count, const size_t stride)
+{
+    PositionDequant dequant;
+    if (count == 0)
+        return dequant;
+
+    float lo[3] = {data[0], data[1], data[2]};
+    float hi[3] = {data[0], data[1], data[2]};
+    for (size_t i = 1; i < count; ++i) {
+        const float* p = data + i * stride;
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = std::min(lo[k], p[k]);
+            hi[k] = std::max(hi[k], p[k]);
+        }
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        const float half = 0.5f * (hi[k] - lo[k]);
+        dequant.scale[k] = half > 0.f ? half : 1.f;     // flat axis: any scale, the value is the offset
+        dequant.offset[k] = 0.5f * (hi[k] + lo[k]);
+    }
+    return dequant;
+}
+
+
+// [-1, 1] -> snorm16
+inline int16_t packSnorm16(const float v)
+{
+    return static_cast<int16_t>(std::lround(std::min(std::max(v, -1.f), 1.f) * 32767.f));
+}
+
+// [0, 1] -> unorm16
+inline uint16_t packUnorm16(const float v)
+{
+    return static_cast<uint16_t>(std::lround(std::min(std::max(v, 0.f), 1.f) * 65535.f));
+}
+
+inline int16_t packPosition(const float v, const float scale, const float offset)
+{
+    return packSnorm16((v - offset) / scale);
+}
+
+// IEEE 754 half, round to nearest; out of range saturates to infinity
+inline uint16_t packHalf(const float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t exp32 = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exp32 == 0xFFu)
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));   // inf, nan
+
+    const int32_t exponent = static_cast<int32_t>(exp32) - 127 + 15;
+    if (exponent >= 31)
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    if (exponent <= 0) {
+        if (exponent < -10)
+            return static_cast<uint16_t>(sign);
+        // subnormal half
+        mantissa |= 0x800000u;
+        const int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u)
+            ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u)
+        ++half;     // a carry into the exponent is still the nearest value
+    return static_cast<uint16_t>(half);
+}
+
+// unit vector -> octahedral map, 2 x snorm16 (decoded in the vertex shader)
+inline void packOctahedral(const glm::vec3& n, int16_t out[2])
+{
+    const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 <= 0.f) {
+        out[0] = 0;
+        out[1] = 0;
+        return;
+    }
+
+    float x = n.x / l1;
+    float y = n.y / l1;
+    if (n.z < 0.f) {
+        // fold the lower hemisphere over the diagonals
+        const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+        const float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+        x = fx;
+        y = fy;
+    }
+    out[0] = packSnorm16(x);
+    out[1] = packSnorm16(y);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in float Layer;
+
+uniform sampler2DArray cameras;
+
+void main()
+{
+    FragColor = vec4(texture(cameras, vec3(TexCoord, Layer)).rgb, 1.0);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+// Raw camera tiles of the multi-view layout: one instance per tile, quad from gl_VertexID (no vertex buffer)
+
+out vec2 TexCoord;
+flat out float Layer;
+
+uniform vec4 tileRect[2];    // Tile in NDC: scale (xy), offset (zw)
+uniform float tileLayer[2];  // Camera texture layer of each tile
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);     // Triangle strip (0,0) (1,0) (0,1) (1,1)
+    vec4 tile = tileRect[gl_InstanceID];
+    
+    gl_Position = vec4((corner * 2.0 - 1.0) * tile.xy + tile.zw, 0.0, 1.0);
+    TexCoord = vec2(corner.x, 1.0 - corner.y);                   // Camera images are stored top row first
+    Layer = tileLayer[gl_InstanceID];
+}
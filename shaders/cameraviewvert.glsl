@@ -0,0 +1,28 @@
+// Prepended to the bowl, direct and car vertex shaders by the renderer (after the defines)
+
+// Shared by all programs, updated once per frame (RENDER_CAMERA_BINDING);
+// MAX_VIEWS is defined by the renderer (RENDER_MAX_VIEWS)
+layout (std140) uniform Camera
+{
+    mat4 view[MAX_VIEWS];
+    mat4 projection[MAX_VIEWS];
+    vec4 viewport[MAX_VIEWS];    // Tile of the view in NDC: scale (xy), offset (zw)
+};
+
+out float gl_ClipDistance[4];
+
+// Instance i is drawn into view i
+vec4 viewPosition(vec4 world)
+{
+    vec4 clip = projection[gl_InstanceID] * view[gl_InstanceID] * world;
+    
+    // Clip to the view's own frustum, then move it into its tile
+    gl_ClipDistance[0] = clip.w + clip.x;
+    gl_ClipDistance[1] = clip.w - clip.x;
+    gl_ClipDistance[2] = clip.w + clip.y;
+    gl_ClipDistance[3] = clip.w - clip.y;
+    
+    vec4 tile = viewport[gl_InstanceID];
+    clip.xy = clip.xy * tile.xy + tile.zw * clip.w;
+    return clip;
+}
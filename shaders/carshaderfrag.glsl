@@ -9,7 +9,13 @@ uniform sampler2D texture_diffuse1;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 uniform vec3 lightColor;
-uniform vec3 objectColor;
+
+// Per-material values, one record per draw (Model::Draw)
+layout (std140) uniform Material {
+    vec4 Ka;
+    vec4 Kd;
+    vec4 Ks_shininess;      // Ks, shininess
+};
 
 void main()
 {
@@ -33,9 +39,9 @@ void main()
     // Texture color
     vec4 texColor = texture(texture_diffuse1, TexCoords);
     
-    // If no texture, use solid color
+    // If no texture, use the material color
     if (texColor.a < 0.1)
-        texColor = vec4(objectColor, 1.0);
+        texColor = vec4(Kd.rgb, 1.0);
     
     // Final color
     vec3 result = (ambient + diffuse + specular) * texColor.rgb;
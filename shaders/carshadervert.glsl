@@ -1,6 +1,10 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+#ifdef COMPACT_VERTICES
+layout (location = 1) in vec2 aNormal;     // Octahedral
+#else
 layout (location = 1) in vec3 aNormal;
+#endif
 layout (location = 2) in vec2 aTexCoords;
 
 out vec2 TexCoords;
@@ -8,14 +12,36 @@ out vec3 Normal;
 out vec3 FragPos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#ifdef COMPACT_VERTICES
+// aPos is snorm16: position = positionOffset + positionScale * aPos (per mesh)
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#endif
+
+// Camera block and viewPosition() come from cameraviewvert.glsl
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+#ifdef COMPACT_VERTICES
+    vec3 pos = positionOffset + positionScale * aPos;
+    vec3 normal = octDecode(aNormal);
+#else
+    vec3 pos = aPos;
+    vec3 normal = aNormal;
+#endif
+    
+    FragPos = vec3(model * vec4(pos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * normal;
     TexCoords = aTexCoords;
     
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    gl_Position = viewPosition(vec4(FragPos, 1.0));
 }
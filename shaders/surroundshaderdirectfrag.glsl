@@ -0,0 +1,35 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec4 CamUV01;
+in vec4 CamUV23;
+in vec4 CamWeights;
+
+uniform sampler2DArray cameras;
+uniform vec4 gains;
+
+void main()
+{
+    vec2 uv[4] = vec2[4](CamUV01.xy, CamUV01.zw, CamUV23.xy, CamUV23.zw);
+
+    // Two strongest cameras at this fragment
+    int first = 0;
+    for (int i = 1; i < 4; i++)
+        if (CamWeights[i] > CamWeights[first]) first = i;
+    int second = (first == 0) ? 1 : 0;
+    for (int i = 0; i < 4; i++)
+        if (i != first && CamWeights[i] > CamWeights[second]) second = i;
+
+    float w0 = CamWeights[first];
+    float w1 = CamWeights[second];
+    if (w0 + w1 <= 0.0) {
+        FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    vec3 color = w0 * gains[first] * texture(cameras, vec3(uv[first], float(first))).rgb;
+    if (w1 > 0.0)
+        color += w1 * gains[second] * texture(cameras, vec3(uv[second], float(second))).rgb;
+
+    FragColor = vec4(color / (w0 + w1), 1.0);
+}
@@ -0,0 +1,32 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec4 aCamUV01;
+layout (location = 3) in vec4 aCamUV23;
+layout (location = 4) in vec4 aCamWeights;
+
+out vec4 CamUV01;
+out vec4 CamUV23;
+out vec4 CamWeights;
+
+uniform mat4 model;
+
+#ifdef COMPACT_VERTICES
+// aPos is snorm16: position = positionOffset + positionScale * aPos
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+#endif
+
+// Camera block and viewPosition() come from cameraviewvert.glsl
+
+void main()
+{
+#ifdef COMPACT_VERTICES
+    vec3 pos = positionOffset + positionScale * aPos;
+#else
+    vec3 pos = aPos;
+#endif
+    gl_Position = viewPosition(model * vec4(pos, 1.0));
+    CamUV01 = aCamUV01;
+    CamUV23 = aCamUV23;
+    CamWeights = aCamWeights;
+}
@@ -1,15 +1,51 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
+layout (location = 0) in vec3 aPos;      // Static mesh position (shape comes from the uniforms below)
+layout (location = 1) in vec2 aTexCoord; // Polar grid: u follows the angle, v the radius
+                                         // (COMPACT_VERTICES: unorm16 of uv / UV_SCALE)
 
 out vec2 TexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Camera block and viewPosition() come from cameraviewvert.glsl
+
+// Bowl shape: flat disk at floor height, paraboloid y = c * ((x / a)^2 + (z / b)^2) around it
+uniform vec4 bowlShape;      // a, b, c, disk radius
+uniform vec2 bowlExtent;     // outer radius, floor height
+uniform vec3 bowlGrid;       // hole, disk and outer radius the static grid was generated with
+
+const float PI = 3.14159265359;
+// UV_SCALE (end of the uv range, Bowl::uv_scale) is defined by the renderer
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    TexCoord = aTexCoord;
+#ifdef COMPACT_VERTICES
+    vec2 uv = aTexCoord * UV_SCALE;
+#else
+    vec2 uv = aTexCoord;
+#endif
+    
+    float theta = 2.0 * PI * uv.x / UV_SCALE;
+    vec2 dir = vec2(cos(theta), sin(theta));
+
+    // Radius of the grid ring (v is linear in r), stretched so disk rings stay on the disk
+    float r_grid = mix(bowlGrid.x, bowlGrid.z, uv.y / UV_SCALE);
+    float r;
+    if (r_grid <= bowlGrid.y) {
+        r = mix(bowlGrid.x, bowlShape.w, (r_grid - bowlGrid.x) / (bowlGrid.y - bowlGrid.x));
+    } else {
+        r = mix(bowlShape.w, bowlExtent.x, (r_grid - bowlGrid.y) / (bowlGrid.z - bowlGrid.y));
+    }
+
+    vec2 xz = r * dir;
+    float y = bowlExtent.y;
+    if (r > bowlShape.w) {
+        // Wall rises from the floor at the disk edge
+        vec2 edge = bowlShape.w * dir / bowlShape.xy;
+        vec2 p = xz / bowlShape.xy;
+        y += bowlShape.z * (dot(p, p) - dot(edge, edge));
+    }
+
+    gl_Position = viewPosition(model * vec4(xz.x, y, xz.y, 1.0));
+    TexCoord = uv;
 }
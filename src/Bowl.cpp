@@ -1,4 +1,21 @@
 #include "Bowl.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
+
+
+namespace {
+        // run fn(row_begin, row_end) over [0, rows) in stripes of at least 16 rows (cv::parallel_for_ pool)
+        template <typename Fn>
+        void parallel_rows(const uint rows, const Fn& fn)
+        {
+                constexpr uint min_rows_per_stripe = 16;
+                cv::parallel_for_(cv::Range(0, static_cast<int>(rows)), [&](const cv::Range& range) {
+                        fn(static_cast<uint>(range.start), static_cast<uint>(range.end));
+                }, std::max(rows / min_rows_per_stripe, 1u));
+        }
+}
 
 
 bool Bowl::generate_mesh_(const float max_size_vert, std::vector<float>& vertices, std::vector<uint>& indices)
@@ -13,99 +30,105 @@ bool Bowl::generate_mesh_(const float max_size_vert, std::vector<float>& vertice
         auto b = param_b;
         auto c = param_c;
 
-        vertices.clear();
-
-        indices.clear();
-
-
         /*
-                prepare grid mesh in polar coordinate with r - radius and theta - angle
+                grid in polar coordinate: rows follow r (radius), columns follow theta (angle)
         */
         // texture coordinates generate (u, v) [0, 1]
         std::vector<float> texture_u = meshgen::linspace(0.f, (1.f + eps_uv), max_size_vert);
-        auto texture_v = texture_u;
+        const auto& texture_v = texture_u;
 
         auto r = meshgen::linspace(hole_rad, rad, max_size_vert); // min_size = 0.f, max_size = 100.f,
         auto theta = meshgen::linspace(0.f, polar_coord, max_size_vert);
-        auto mesh_pair = meshgen::meshgrid(r, theta);
-
-        auto R = std::get<0>(mesh_pair);
-        auto THETA = std::get<1>(mesh_pair);
-        size_t grid_size = R.size();
-        std::vector<float> x_grid;
-        std::vector<float> y_grid;
-        std::vector<float> z_grid;
-
-        // Convert to rectangular coordinates
-        // x = r*cos(theta), z = r*sin(theta), y/c = (x^2)/(a^2) + (z^2)/(b^2);
-        for (int i = 0; i < grid_size; ++i) {
-                for (int j = 0; j < grid_size; ++j) {
-                        auto x = R(i, j) * cos(THETA(i, j));
-                        auto z = R(i, j) * sin(THETA(i, j));
-                        auto y = c * (pow((x / a), 2) + pow((z / b), 2));
-                        x_grid.push_back(x);
-                        z_grid.push_back(z);
-                        y_grid.push_back(y);
-                }
+        const uint grid_size = static_cast<uint>(r.size());
+        const uint stride = useUV ? 5 : _num_vertices;
+
+        // angle terms once per column, in double as the per-element version evaluated them
+        std::vector<double> cos_theta(grid_size), sin_theta(grid_size);
+        for (uint j = 0; j < grid_size; ++j) {
+                cos_theta[j] = std::cos(static_cast<double>(theta[j]));
+                sin_theta[j] = std::sin(static_cast<double>(theta[j]));
         }
 
+        vertices.resize(static_cast<size_t>(grid_size) * grid_size * stride);
+        indices.clear();
+
+        /*
+                one pass: positions on the paraboloid, texture coordinates, and the disk vertices
+                (inside inner radius) of every row; the first disk vertex of the last row
+                that has one sets the disk level
+        */
+        std::vector<uint8_t> on_disk(static_cast<size_t>(grid_size) * grid_size);
+        std::vector<uint8_t> row_on_disk(grid_size, 0);
+        std::vector<float> row_min_y(grid_size, 0.f);
+        auto half_grid = grid_size / 2;
+
+        parallel_rows(grid_size, [&](const uint row_begin, const uint row_end) {
+                for (uint i = row_begin; i < row_end; ++i) {
+                        float* vert = &vertices[static_cast<size_t>(i) * grid_size * stride];
+                        uint8_t* disk = &on_disk[static_cast<size_t>(i) * grid_size];
+                        double r_i = r[i];
+
+                        for (uint j = 0; j < grid_size; ++j, vert += stride) {
+                                // x = r*cos(theta), z = r*sin(theta), y/c = (x^2)/(a^2) + (z^2)/(b^2);
+                                auto xd = r_i * cos_theta[j];
+                                auto zd = r_i * sin_theta[j];
+                                auto x = static_cast<float>(xd);
+                                auto z = static_cast<float>(zd);
+                                auto y = static_cast<float>(c * ((xd / a) * (xd / a) + (zd / b) * (zd / b)));
+
+                                disk[j] = !gt_radius(x, z, inner_rad);
+                                if (disk[j] && !row_on_disk[i]) {
+                                        row_on_disk[i] = 1;
+                                        row_min_y[i] = y;
+                                }
+
+                                vert[0] = x + cen[0];
+                                vert[1] = y + cen[1];
+                                vert[2] = z + cen[2];
+
+                                if (useUV) { // texture coordinates
+                                        auto u = texture_u[j];
+                                        auto v = texture_v[i];
+                                        if (i == 0 && j == 0 &&  !set_hole) // center disk
+                                            u = texture_u[half_grid];
+                                        vert[3] = u;
+                                        vert[4] = v;
+                                }
+                        }
+                }
+        });
+
         /*
                 find start level - level when disk passes from to elliptic paraboloid
         */
         auto min_y = 0.f;
         auto idx_min_y = 0u; // index y - component when transition between disk and paraboloid
-        for (int i = 0; i < grid_size; ++i) {
-                for (int j = 0; j < grid_size; ++j) {
-                        auto x = x_grid[j + i * grid_size];
-                        auto z = z_grid[j + i * grid_size];
-                        if (lt_radius(x, z, inner_rad)) { // check level of paraboloid
-                                min_y = y_grid[j + i * grid_size];
-                                idx_min_y = i;
-                                break;
-                        }
+        for (uint i = 0; i < grid_size; ++i) {
+                if (row_on_disk[i]) {
+                        min_y = row_min_y[i];
+                        idx_min_y = i;
                 }
         }
 
-
-        /*
-                generate mesh vertices for disk and elliptic paraboloid
-        */
-        auto half_grid = grid_size / 2;
-        auto vertices_size = 0;
-        auto offset_idx_min_y = 0;
-        for (int i = 0; i < grid_size; ++i) {
-                for (int j = 0; j < grid_size; ++j) {
-                        auto x = x_grid[j + i * grid_size];
-                        auto z = z_grid[j + i * grid_size];
-
-
-                        auto y = min_y;
-                        if (gt_radius(x, z, inner_rad)) // check level of paraboloid
-                                y = y_grid[j + i * grid_size];
-
-                        vertices.push_back(x + cen[0]);
-                        vertices.push_back(y + cen[1]);
-                        vertices.push_back(z + cen[2]);
-                        vertices_size += 3;
-
-                        if (useUV) { // texture coordinates
-                                auto u = texture_u[j];
-                                auto v = texture_v[i];
-                                if (i == 0 && j == 0 &&  !set_hole) // center disk
-                                    u = texture_u[half_grid];
-                                vertices.push_back(u);
-                                vertices.push_back(v);
+        // flatten the disk
+        parallel_rows(grid_size, [&](const uint row_begin, const uint row_end) {
+                for (uint i = row_begin; i < row_end; ++i) {
+                        if (!row_on_disk[i])
+                                continue;
+                        for (uint j = 0; j < grid_size; ++j) {
+                                auto k = static_cast<size_t>(i) * grid_size + j;
+                                if (on_disk[k])
+                                        vertices[k * stride + 1] = min_y + cen[1];
                         }
                 }
-        }
+        });
 
 
         /*
                 generate indices by y-order
         */
-
-        idx_min_y -= offset_idx_min_y;
-        int32 last_vert = vertices_size / _num_vertices;
+        int32 last_vert = grid_size * grid_size;
+        indices.reserve(static_cast<size_t>(grid_size - 1) * grid_size * 2 + 1);
         generate_indices(indices, grid_size, idx_min_y, last_vert);
 
         return true;
@@ -113,19 +136,24 @@ bool Bowl::generate_mesh_(const float max_size_vert, std::vector<float>& vertice
 
 
 void Bowl::generate_indices(std::vector<uint>& indices, const uint grid_size, const uint idx_min_y, const int32 last_vert) {
+    generate_indices(indices, grid_size, grid_size, idx_min_y, last_vert);
+}
+
+
+void Bowl::generate_indices(std::vector<uint>& indices, const uint rows, const uint cols, const uint idx_min_y, const int32 last_vert) {
     bool oddRow = false;
 
-    for (uint y = 0; y < grid_size - 1; ++y) {
+    for (uint y = 0; y < rows - 1; ++y) {
             if (!oddRow) // even rows: y == 0, y == 2; and so on
             {
-                    for (uint x = 0; x < grid_size; ++x)
+                    for (uint x = 0; x < cols; ++x)
                     {
-                            auto current = y * grid_size + x;
-                            auto next = (y + 1) * grid_size + x;
+                            auto current = y * cols + x;
+                            auto next = (y + 1) * cols + x;
                             /* change order when change disk to elliptic paraboloid */
                             if (y == idx_min_y && x == 0) {
                                     std::swap(current, next);
-                                    indices.push_back(current - grid_size);
+                                    indices.push_back(current - cols);
                                     indices.push_back(next);
                                     indices.push_back(current);
                                     continue;
@@ -138,13 +166,13 @@ void Bowl::generate_indices(std::vector<uint>& indices, const uint grid_size, co
             }
             else
             {
-                    for (int x = grid_size - 1; x >= 0; --x)
+                    for (int x = cols - 1; x >= 0; --x)
                     {
-                            auto current = (y + 1) * grid_size + x;
-                            auto prev = y * grid_size + x;
+                            auto current = (y + 1) * cols + x;
+                            auto prev = y * cols + x;
                             /* change order when change disk to elliptic paraboloid */
-                            if (y == idx_min_y && x == grid_size - 1) {
-                                    indices.push_back(current - grid_size);
+                            if (y == idx_min_y && x == cols - 1) {
+                                    indices.push_back(current - cols);
                                     indices.push_back(current);
                                     indices.push_back(prev);
                                     continue;
@@ -161,6 +189,188 @@ void Bowl::generate_indices(std::vector<uint>& indices, const uint grid_size, co
 }
 
 
+std::vector<float> Bowl::lod_radii(const uint rings, const float hole_radius) const
+{
+        /*
+                half of the rings on the disk [hole, inner] with cosine spacing (dense at the hole
+                and at the transition), the rest on the paraboloid (inner, rad] getting sparser outwards
+        */
+        const uint disk_rings = rings / 2;
+        const uint parab_rings = rings - disk_rings;
+
+        std::vector<float> radii;
+        radii.reserve(rings);
+
+        for (uint k = 0; k < disk_rings; ++k) {
+                auto s = static_cast<float>(k) / (disk_rings - 1);
+                radii.push_back(hole_radius + (inner_rad - hole_radius) * 0.5f * (1.f - std::cos(PI * s)));
+        }
+        for (uint k = 1; k <= parab_rings; ++k) {
+                auto s = static_cast<float>(k) / parab_rings;
+                radii.push_back(inner_rad + (rad - inner_rad) * s * std::sqrt(s));
+        }
+
+        return radii;
+}
+
+
+float Bowl::lod_max_edge(const uint rings, const uint segments, const float hole_radius) const
+{
+        auto radii = lod_radii(rings, hole_radius);
+        auto max_edge = rad * polar_coord / (segments - 1); // outermost ring
+        for (size_t k = 1; k < radii.size(); ++k)
+                max_edge = std::max(max_edge, radii[k] - radii[k - 1]);
+        return max_edge;
+}
+
+
+bool Bowl::generate_mesh_lod(const uint rings, const uint segments, const float hole_radius,
+                             const uint band_columns, std::vector<float>& vertices,
+                             std::vector<uint16_t>& indices, std::vector<BowlIndexChunk>& chunks)
+{
+        if (fabs(param_a) <= epsilon || fabs(param_b) <= epsilon || fabs(param_c) <= epsilon)
+                return false;
+        if (rad <= 0.f || inner_rad <= 0.f)
+                return false;
+        if (hole_radius <= 0.f || hole_radius >= inner_rad || inner_rad >= rad)
+                return false;
+        if (rings < 4 || segments < 3)
+                return false;
+
+        set_hole = true;
+        useUV = true;
+        hole_rad = hole_radius;
+        polar_coord = 2 * PI;
+
+        auto a = param_a;
+        auto b = param_b;
+        auto c = param_c;
+
+        auto radii = lod_radii(rings, hole_rad);
+
+        // disk level: paraboloid height at the transition ring (theta = 0), as in generate_mesh_
+        auto min_y = c * (inner_rad / a) * (inner_rad / a);
+
+        std::vector<float> cos_theta(segments), sin_theta(segments);
+        for (uint j = 0; j < segments; ++j) {
+                auto theta = polar_coord * static_cast<float>(j) / (segments - 1);
+                cos_theta[j] = std::cos(theta);
+                sin_theta[j] = std::sin(theta);
+        }
+
+        vertices.resize(static_cast<size_t>(rings) * segments * 5);
+
+        // rows follow radius, columns follow theta (same layout as generate_mesh_)
+        parallel_rows(rings, [&](const uint row_begin, const uint row_end) {
+                for (uint i = row_begin; i < row_end; ++i) {
+                        float* vert = &vertices[static_cast<size_t>(i) * segments * 5];
+                        auto r = radii[i];
+                        // v is linear in r, as on the uniform grid
+                        auto v = (r - hole_rad) / (rad - hole_rad) * (1.f + eps_uv);
+                        auto on_disk = (r <= inner_rad);
+
+                        for (uint j = 0; j < segments; ++j, vert += 5) {
+                                auto x = r * cos_theta[j];
+                                auto z = r * sin_theta[j];
+                                auto y = on_disk ? min_y : c * ((x / a) * (x / a) + (z / b) * (z / b));
+
+                                vert[0] = x + cen[0];
+                                vert[1] = y + cen[1];
+                                vert[2] = z + cen[2];
+                                vert[3] = static_cast<float>(j) / (segments - 1) * (1.f + eps_uv);
+                                vert[4] = v;
+                        }
+                }
+        });
+
+        // disk and paraboloid share the ring grid, so the strips need no transition join
+        return generate_strip_chunks(rings, segments, band_columns, indices, chunks);
+}
+
+
+bool Bowl::generate_strip_chunks(const uint rows, const uint cols, const uint band_columns,
+                                 std::vector<uint16_t>& indices, std::vector<BowlIndexChunk>& chunks)
+{
+        indices.clear();
+        chunks.clear();
+
+        // strip_restart is reserved, so a chunk addresses vertices 0 .. 65534
+        const uint max_rows = static_cast<uint>(strip_restart) / cols;
+        if (rows < 2 || cols < 2 || band_columns < 1 || max_rows < 2)
+                return false;
+
+        const uint bands = (cols - 1 + band_columns - 1) / band_columns;
+        indices.reserve(static_cast<size_t>(rows - 1) * (cols - 1 + bands) * 2 + (rows - 1) * bands);
+
+        // consecutive chunks share their boundary row
+        for (uint row_begin = 0; row_begin < rows - 1; row_begin += max_rows - 1) {
+                const uint row_end = std::min(row_begin + max_rows - 1, rows - 1); // last row of the chunk
+
+                BowlIndexChunk chunk;
+                chunk.base_vertex = row_begin * cols;
+                chunk.index_offset = static_cast<uint32_t>(indices.size());
+
+                for (uint col_begin = 0; col_begin < cols - 1; col_begin += band_columns) {
+                        const uint col_end = std::min(col_begin + band_columns, cols - 1);
+
+                        for (uint y = row_begin; y < row_end; ++y) {
+                                if (indices.size() > chunk.index_offset)
+                                        indices.push_back(strip_restart);
+
+                                const auto current_row = (y - row_begin) * cols;
+                                const auto next_row = current_row + cols;
+                                for (uint x = col_begin; x <= col_end; ++x) {
+                                        indices.push_back(static_cast<uint16_t>(current_row + x));
+                                        indices.push_back(static_cast<uint16_t>(next_row + x));
+                                }
+                        }
+                }
+
+                chunk.index_count = static_cast<uint32_t>(indices.size()) - chunk.index_offset;
+                chunks.push_back(chunk);
+        }
+
+        return true;
+}
+
+
+float Bowl::strip_acmr(const std::vector<uint16_t>& indices, const std::vector<BowlIndexChunk>& chunks,
+                       const uint cache_size)
+{
+        size_t misses = 0;
+        size_t triangles = 0;
+
+        for (const auto& chunk : chunks) {
+                std::deque<uint32_t> fifo;
+                std::unordered_set<uint32_t> cached;
+                size_t strip_length = 0;
+
+                for (uint32_t k = chunk.index_offset; k < chunk.index_offset + chunk.index_count; ++k) {
+                        if (indices[k] == strip_restart) {
+                                strip_length = 0;
+                                continue;
+                        }
+                        if (++strip_length >= 3)
+                                ++triangles;
+
+                        const uint32_t vertex = chunk.base_vertex + indices[k];
+                        if (cached.count(vertex))
+                                continue;
+
+                        ++misses;
+                        fifo.push_back(vertex);
+                        cached.insert(vertex);
+                        if (fifo.size() > cache_size) {
+                                cached.erase(fifo.front());
+                                fifo.pop_front();
+                        }
+                }
+        }
+
+        return triangles ? static_cast<float>(misses) / triangles : 0.f;
+}
+
+
 
 bool HemiSphere::generate_mesh_(std::vector<float>& vertices, std::vector<uint>& indices)
 {
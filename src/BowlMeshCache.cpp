@@ -0,0 +1,211 @@
+#include "BowlMeshCache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char CACHE_MAGIC[8] = { 'S', 'V', 'B', 'O', 'W', 'L', 0, 0 };
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t lod_count;
+    float shape[6];         // a, b, c, disk_radius, parab_radius, hole_radius
+    uint32_t band_columns;
+    uint32_t reserved;
+};
+
+struct LodEntry {
+    uint32_t rings;
+    uint32_t segments;
+    float max_edge;
+    float acmr;
+    uint64_t vertex_offset;
+    uint64_t vertex_floats;
+    uint64_t index_offset;
+    uint64_t index_count;
+    uint64_t chunk_offset;
+    uint64_t chunk_count;
+};
+
+void fillShape(const ConfigBowl& config, float shape[6]) {
+    shape[0] = config.a;
+    shape[1] = config.b;
+    shape[2] = config.c;
+    shape[3] = config.disk_radius;
+    shape[4] = config.parab_radius;
+    shape[5] = config.hole_radius;
+}
+
+// Contents of a LOD whose byte ranges are inside the file: every chunk draws
+// from its own index range and only addresses vertices of the LOD
+bool checkLodData(const LodEntry& entry, const uint8_t* base) {
+    const uint64_t vertex_count = static_cast<uint64_t>(entry.rings) * entry.segments;
+    if (entry.vertex_floats != vertex_count * 5) {
+        return false;
+    }
+
+    const auto* indices = reinterpret_cast<const uint16_t*>(base + entry.index_offset);
+    const auto* chunks = reinterpret_cast<const BowlIndexChunk*>(base + entry.chunk_offset);
+
+    for (uint64_t c = 0; c < entry.chunk_count; c++) {
+        const BowlIndexChunk& chunk = chunks[c];
+        if (static_cast<uint64_t>(chunk.index_offset) + chunk.index_count > entry.index_count) {
+            return false;
+        }
+
+        uint32_t max_index = 0;
+        for (uint32_t k = chunk.index_offset; k < chunk.index_offset + chunk.index_count; k++) {
+            if (indices[k] != Bowl::strip_restart) {
+                max_index = std::max<uint32_t>(max_index, indices[k]);
+            }
+        }
+        if (static_cast<uint64_t>(chunk.base_vertex) + max_index >= vertex_count) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+BowlMeshCache::BowlMeshCache() {
+}
+
+BowlMeshCache::~BowlMeshCache() {
+    release();
+}
+
+void BowlMeshCache::release() {
+    file.release();
+    lods.clear();
+}
+
+bool BowlMeshCache::load(const std::string& path, const ConfigBowl& config,
+                         const std::vector<uint32_t>& rings, const std::vector<uint32_t>& segments,
+                         uint32_t band_columns) {
+    release();
+
+    if (!file.open(path, sizeof(FileHeader), CACHE_MAGIC, sizeof(CACHE_MAGIC))) {
+        return false;
+    }
+
+    const size_t file_size = file.size();
+    const uint8_t* base = file.data();
+    const auto* header = reinterpret_cast<const FileHeader*>(base);
+
+    float shape[6];
+    fillShape(config, shape);
+
+    if (header->version != VERSION ||
+        header->lod_count != rings.size() ||
+        header->band_columns != band_columns ||
+        std::memcmp(header->shape, shape, sizeof(shape)) != 0 ||
+        file_size < sizeof(FileHeader) + header->lod_count * sizeof(LodEntry)) {
+        std::cout << "Bowl cache: " << path << " is stale, regenerating" << std::endl;
+        release();
+        return false;
+    }
+
+    const auto* entries = reinterpret_cast<const LodEntry*>(base + sizeof(FileHeader));
+
+    for (uint32_t i = 0; i < header->lod_count; i++) {
+        const LodEntry& entry = entries[i];
+
+        if (entry.rings != rings[i] || entry.segments != segments[i] ||
+            entry.vertex_offset + entry.vertex_floats * sizeof(float) > file_size ||
+            entry.index_offset + entry.index_count * sizeof(uint16_t) > file_size ||
+            entry.chunk_offset + entry.chunk_count * sizeof(BowlIndexChunk) > file_size) {
+            std::cout << "Bowl cache: " << path << " does not match LOD " << i << ", regenerating" << std::endl;
+            release();
+            return false;
+        }
+
+        if (!checkLodData(entry, base)) {
+            std::cout << "Bowl cache: " << path << " has inconsistent vertices or indices in LOD " << i << ", regenerating" << std::endl;
+            release();
+            return false;
+        }
+
+        LodView view;
+        view.rings = entry.rings;
+        view.segments = entry.segments;
+        view.max_edge = entry.max_edge;
+        view.acmr = entry.acmr;
+        view.vertices = reinterpret_cast<const float*>(base + entry.vertex_offset);
+        view.vertex_floats = entry.vertex_floats;
+        view.indices = reinterpret_cast<const uint16_t*>(base + entry.index_offset);
+        view.index_count = entry.index_count;
+        view.chunks = reinterpret_cast<const BowlIndexChunk*>(base + entry.chunk_offset);
+        view.chunk_count = entry.chunk_count;
+        lods.push_back(view);
+    }
+
+    return true;
+}
+
+bool BowlMeshCache::save(const std::string& path, const ConfigBowl& config, uint32_t band_columns,
+                         const std::vector<BowlMeshLod>& lods) {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+    header.lod_count = static_cast<uint32_t>(lods.size());
+    header.band_columns = band_columns;
+    fillShape(config, header.shape);
+
+    // Lay out the data blocks after the header and the LOD table
+    std::vector<LodEntry> entries(lods.size());
+    size_t offset = sizeof(FileHeader) + lods.size() * sizeof(LodEntry);
+
+    for (size_t i = 0; i < lods.size(); i++) {
+        LodEntry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.rings = lods[i].rings;
+        entry.segments = lods[i].segments;
+        entry.max_edge = lods[i].max_edge;
+        entry.acmr = lods[i].acmr;
+
+        offset = AtomicFileWriter::alignUp(offset);
+        entry.vertex_offset = offset;
+        entry.vertex_floats = lods[i].vertices.size();
+        offset += entry.vertex_floats * sizeof(float);
+
+        offset = AtomicFileWriter::alignUp(offset);
+        entry.index_offset = offset;
+        entry.index_count = lods[i].indices.size();
+        offset += entry.index_count * sizeof(uint16_t);
+
+        offset = AtomicFileWriter::alignUp(offset);
+        entry.chunk_offset = offset;
+        entry.chunk_count = lods[i].chunks.size();
+        offset += entry.chunk_count * sizeof(BowlIndexChunk);
+    }
+
+    AtomicFileWriter out(path);
+    if (!out.isOpen()) {
+        std::cerr << "Bowl cache: cannot write " << out.getTmpPath() << std::endl;
+        return false;
+    }
+
+    out.write(&header, sizeof(header));
+    out.write(entries.data(), entries.size() * sizeof(LodEntry));
+
+    for (size_t i = 0; i < lods.size(); i++) {
+        out.padTo(entries[i].vertex_offset);
+        out.write(lods[i].vertices.data(), lods[i].vertices.size() * sizeof(float));
+        out.padTo(entries[i].index_offset);
+        out.write(lods[i].indices.data(), lods[i].indices.size() * sizeof(uint16_t));
+        out.padTo(entries[i].chunk_offset);
+        out.write(lods[i].chunks.data(), lods[i].chunks.size() * sizeof(BowlIndexChunk));
+    }
+
+    if (!out.commit()) {
+        std::cerr << "Bowl cache: write failed for " << path << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,104 @@
+#include "MappedFile.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// ============================================================================
+// MappedFile
+// ============================================================================
+
+MappedFile::MappedFile()
+    : mapped(nullptr), mapped_size(0) {
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+bool MappedFile::open(const std::string& path, size_t min_size, const char* magic, size_t magic_size) {
+    release();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+        static_cast<size_t>(st.st_size) < std::max(min_size, magic_size)) {
+        close(fd);
+        return false;
+    }
+
+    const size_t file_size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        std::cerr << "mmap failed for " << path << std::endl;
+        return false;
+    }
+
+    if (magic && std::memcmp(data, magic, magic_size) != 0) {
+        munmap(data, file_size);
+        return false;
+    }
+
+    mapped = data;
+    mapped_size = file_size;
+    return true;
+}
+
+void MappedFile::release() {
+    if (mapped) {
+        munmap(mapped, mapped_size);
+        mapped = nullptr;
+        mapped_size = 0;
+    }
+}
+
+// ============================================================================
+// AtomicFileWriter
+// ============================================================================
+
+AtomicFileWriter::AtomicFileWriter(const std::string& path)
+    : path(path), tmp_path(path + ".tmp"),
+      out(tmp_path, std::ios::binary | std::ios::trunc), committed(false) {
+}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    if (!committed) {
+        out.close();
+        std::remove(tmp_path.c_str());
+    }
+}
+
+void AtomicFileWriter::write(const void* data, size_t size) {
+    out.write(static_cast<const char*>(data), size);
+}
+
+void AtomicFileWriter::padTo(uint64_t offset) {
+    static const char zeros[DATA_ALIGNMENT] = {};
+    auto pos = static_cast<uint64_t>(out.tellp());
+    while (out && offset > pos) {
+        const auto count = std::min<uint64_t>(offset - pos, sizeof(zeros));
+        out.write(zeros, count);
+        pos += count;
+    }
+}
+
+bool AtomicFileWriter::commit() {
+    out.close();
+    if (!out || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    committed = true;
+    return true;
+}
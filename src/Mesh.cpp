@@ -3,15 +3,56 @@
 
 
 Mesh::Mesh(const std::vector<Vertex>& vertices_, const std::vector<uint>& indices_ ,
-           const std::vector<Texture>& textures_, const MaterialInfo& material_) :
-            vertices(vertices_), indices(indices_), textures(textures_), material(material_), VAO(0), VBO(0), EBO(0)
+           const std::vector<Texture>& textures_, const MaterialInfo& material_, const uint materialIndex_,
+           const bool compact_) :
+            vertices(vertices_), indices(indices_), textures(textures_), material(material_), VAO(0), VBO(0), EBO(0),
+            indexCount(0), materialIndex(materialIndex_), compact(compact_),
+            positionScaleLocation(-1), positionOffsetLocation(-1), samplerProgram(0)
 {
-     initMesh();
+     initMesh(vertices.data(), vertices.size(), indices.data(), indices.size());
+     initSamplerNames();
 }
 
 
-void Mesh::initMesh()
+Mesh::Mesh(const Vertex* vertices_, const size_t vertex_count, const uint* indices_, const size_t index_count,
+           const std::vector<Texture>& textures_, const MaterialInfo& material_, const uint materialIndex_,
+           const bool compact_) :
+            textures(textures_), material(material_), VAO(0), VBO(0), EBO(0), indexCount(0), materialIndex(materialIndex_),
+            compact(compact_), positionScaleLocation(-1), positionOffsetLocation(-1), samplerProgram(0)
 {
+     initMesh(vertices_, vertex_count, indices_, index_count);
+     initSamplerNames();
+}
+
+
+void Mesh::initSamplerNames()
+{
+    size_t diffuseNr = 1;
+    size_t specularNr = 1;
+    size_t normalNr = 1;
+    size_t heightNr = 1;
+
+    for (const auto& texture : textures) {
+        std::string number;
+        TexType name = texture.type;
+        if (name == tex_DIFFUSE)
+          number = std::to_string(diffuseNr++);
+        else if(name == tex_SPECULAR)
+          number = std::to_string(specularNr++);
+        else if(name == tex_NORMAL)
+          number = std::to_string(normalNr++);
+        else if(name == tex_HEIGHT)
+          number = std::to_string(heightNr++);
+
+        samplerNames.push_back(texture.name + number);
+    }
+}
+
+
+void Mesh::initMesh(const Vertex* vertices_, const size_t vertex_count, const uint* indices_, const size_t index_count)
+{
+    indexCount = index_count;
+
     glGenVertexArrays(1, &VAO);
 
     glGenBuffers(1, &VBO);
@@ -19,12 +60,19 @@ void Mesh::initMesh()
     glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(uint), indices_, GL_STATIC_DRAW);
+
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    if (compact) {
+        initCompactMesh(vertices_, vertex_count);
+        glBindVertexArray(0);
+        return;
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(Vertex), vertices_, GL_STATIC_DRAW);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
@@ -39,41 +87,72 @@ void Mesh::initMesh()
 }
 
 
+void Mesh::initCompactMesh(const Vertex* vertices_, const size_t vertex_count)
+{
+    static_assert(sizeof(Vertex) % sizeof(float) == 0, "Vertex must be a float array");
+    positionDequant = computePositionDequant(&vertices_[0].position.x, vertex_count, sizeof(Vertex) / sizeof(float));
+
+    std::vector<PackedVertex> packed(vertex_count);
+    for (size_t i = 0; i < vertex_count; ++i) {
+        const Vertex& v = vertices_[i];
+        PackedVertex& p = packed[i];
+        for (int k = 0; k < 3; ++k)
+            p.position[k] = packPosition(v.position[k], positionDequant.scale[k], positionDequant.offset[k]);
+        p.position[3] = 0;
+        packOctahedral(v.normal, p.normal);
+        p.texcoords[0] = packHalf(v.texcoords.x);
+        p.texcoords[1] = packHalf(v.texcoords.y);
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texcoords));
+}
+
+
 void Mesh::Draw(Shader& shader)
 {
-    size_t diffuseNr = 1;
-    size_t specularNr = 1;
-    size_t normalNr = 1;
-    size_t heightNr = 1;
+    Draw(shader.getShaderProgram());
+}
 
-    for (auto i = 0u; i < textures.size(); ++i){
-        glActiveTexture(GL_TEXTURE0 + i);
-        std::string number;
-        TexType name = textures[i].type;
-        if (name == tex_DIFFUSE)
-          number = std::to_string(diffuseNr++);
-        else if(name == tex_SPECULAR)
-          number = std::to_string(specularNr++);
-        else if(name == tex_NORMAL)
-          number = std::to_string(normalNr++);
-        else if(name == tex_HEIGHT)
-          number = std::to_string(heightNr++);
 
-        shader.setInt((textures[i].name + number), i); // material
+void Mesh::Draw(const GLuint program, const GLsizei instances)
+{
+    // uniform locations are looked up once per program
+    if (program != samplerProgram) {
+        samplerLocations.clear();
+        for (const auto& name : samplerNames)
+            samplerLocations.push_back(glGetUniformLocation(program, name.c_str()));
+        positionScaleLocation = glGetUniformLocation(program, "positionScale");
+        positionOffsetLocation = glGetUniformLocation(program, "positionOffset");
+        samplerProgram = program;
+    }
 
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+    if (compact) {
+        glUniform3fv(positionScaleLocation, 1, &positionDequant.scale[0]);
+        glUniform3fv(positionOffsetLocation, 1, &positionDequant.offset[0]);
     }
 
-    // TODO add case for Default Material
-    shader.setVec3("Ka", material.ambient);
-    shader.setVec3("Kd", material.diffuse);
-    shader.setVec3("Ks", material.specular);
-    shader.setFloat("shininess", material.shininess);
+    for (auto i = 0u; i < textures.size(); ++i){
+        glActiveTexture(GL_TEXTURE0 + i);
+        glUniform1i(samplerLocations[i], i); // material
+        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+    }
 
 
     // draw mesh
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    if (instances > 1)
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instances);
+    else
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
 
     glBindVertexArray(0);
     glActiveTexture(GL_TEXTURE0);
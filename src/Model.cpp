@@ -1,4 +1,5 @@
 #include <Model.hpp>
+#include <ModelBinary.hpp>
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -6,19 +7,214 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 #define GL_BGR  0x80E0
 #define GL_BGRA 0x80E1
 
-uint TextureFromFile(const char* path, const std::string& directory);
+
+// std140 layout of the "Material" uniform block
+struct MaterialBlock
+{
+    float Ka[4];
+    float Kd[4];
+    float Ks_shininess[4];      // Ks, shininess
+};
+
+
+/*
+    decodes (imread + swizzle to RGB/RGBA) on worker threads while the meshes are built;
+    texture names are reserved immediately so meshes can reference them, the GL uploads
+    happen in one batch on the GL thread in uploadAll()
+*/
+class TextureDecodePool
+{
+public:
+    explicit TextureDecodePool(unsigned workers);
+    ~TextureDecodePool();
+
+    void submit(const GLuint id, const std::string& filename);
+
+    // wait for the decodes and upload them (GL thread)
+    void uploadAll();
+
+private:
+    struct Job
+    {
+        GLuint id;
+        std::string filename;
+        cv::Mat image;
+        float decode_ms = 0.f;
+        bool done = false;
+    };
+
+    void worker();
+
+    std::vector<std::thread> threads;
+    std::deque<Job> jobs;           // stable addresses while new jobs are appended
+    size_t next_job = 0;
+    size_t finished = 0;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+};
+
+
+TextureDecodePool::TextureDecodePool(unsigned workers)
+{
+    for (unsigned i = 0; i < std::max(workers, 1u); ++i)
+        threads.emplace_back(&TextureDecodePool::worker, this);
+}
+
+
+TextureDecodePool::~TextureDecodePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+
+void TextureDecodePool::submit(const GLuint id, const std::string& filename)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(Job{id, filename});
+    }
+    job_ready.notify_one();
+}
+
+
+void TextureDecodePool::worker()
+{
+    for (;;) {
+        Job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [this] {return stopping || next_job < jobs.size();});
+            if (next_job >= jobs.size())
+                return;
+            job = &jobs[next_job++];
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        cv::Mat image = cv::imread(job->filename, cv::IMREAD_UNCHANGED);
+        if (image.data) {
+            if (image.channels() == 3)
+                cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
+            else if (image.channels() == 4)
+                cv::cvtColor(image, image, cv::COLOR_BGRA2RGBA);
+        }
+        float decode_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job->image = image;
+            job->decode_ms = decode_ms;
+            job->done = true;
+            ++finished;
+        }
+        job_done.notify_all();
+    }
+}
+
+
+void TextureDecodePool::uploadAll()
+{
+    auto wait_start = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        job_done.wait(lock, [this] {return finished == jobs.size();});
+    }
+    float wait_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - wait_start).count();
+
+    auto upload_start = std::chrono::steady_clock::now();
+    float decode_ms = 0.f;
+    size_t uploaded = 0;
+
+    // decoded rows are tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (auto& job : jobs) {
+        decode_ms += job.decode_ms;
+        if (!job.image.data) {
+            // name stays without storage (samples as black, like id 0 before)
+            std::cerr << "Texture failed to load at path: " << job.filename << "\n";
+            continue;
+        }
+
+        GLenum format = GL_RGB;
+        if (job.image.channels() == 1)
+            format = GL_RED;
+        else if (job.image.channels() == 4)
+            format = GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, job.id);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, job.image.cols, job.image.rows, 0, format, GL_UNSIGNED_BYTE, job.image.data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        job.image.release();
+        ++uploaded;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!jobs.empty()) {
+        float upload_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - upload_start).count();
+        std::cout << "Model textures: " << uploaded << "/" << jobs.size() << " decoded on " << threads.size()
+                  << " workers (" << decode_ms << " ms decode total, " << wait_ms << " ms waited, "
+                  << upload_ms << " ms upload)\n";
+    }
+}
 
 void Model::InitModel(const std::string& pathmodel)
 {
     if (isInit)
         return;
 
-    loadModel(pathmodel);
+    auto start = std::chrono::steady_clock::now();
+
+    auto slash = pathmodel.find_last_of('/');
+    directory = (slash == std::string::npos) ? std::string(".") : pathmodel.substr(0, slash);
+
+    TextureDecodePool pool(std::min(std::thread::hardware_concurrency(), 4u));
+    decodePool = &pool;
+
+    // preprocessed binary (ModelConvert) if it is up to date, Assimp import otherwise
+    ModelBinary binary;
+    bool from_binary = binary.load(ModelBinary::binaryPath(pathmodel), pathmodel);
+    if (from_binary)
+        loadBinary(binary);
+    else
+        loadModel(pathmodel);
+
+    pool.uploadAll();
+    decodePool = nullptr;
+
+    initMaterialBuffer();
+
+    float load_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Model loaded " << (from_binary ? "from " + ModelBinary::binaryPath(pathmodel) : "with Assimp")
+              << ": " << sourceMeshes << " meshes in " << meshes.size() << " material batches ("
+              << load_ms << " ms)\n";
 
     isInit = true;
 }
@@ -27,14 +223,12 @@ void Model::InitModel(const std::string& pathmodel)
 void Model::loadModel(const std::string& path)
 {
     Assimp::Importer import_;
-    const aiScene* scene = import_.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs);
+    const aiScene* scene = import_.ReadFile(path, MODEL_IMPORT_FLAGS);
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode){
         std::cerr << "Error Assimp: " << import_.GetErrorString() << "\n";
         exit(EXIT_FAILURE);
     }
 
-    directory = path.substr(0, path.find_last_of('/'));
-
     if (scene->HasMaterials()){
         for(auto i = 0; i < scene->mNumMaterials; ++i){
             MaterialInfo mater = processMaterial(scene->mMaterials[i]);
@@ -42,7 +236,36 @@ void Model::loadModel(const std::string& path)
         }
     }
 
+    batches.resize(materials.size());
     processNode(scene->mRootNode, scene);
+
+    // one mesh (vertex/index buffer, draw call) per used material
+    for (size_t m = 0; m < batches.size(); ++m) {
+        MeshBatch& batch = batches[m];
+        if (batch.indices.empty())
+            continue;
+        meshes.emplace_back(batch.vertices.data(), batch.vertices.size(), batch.indices.data(), batch.indices.size(),
+                            batch.textures, materials[m], static_cast<uint>(m), compactVertices);
+        sourceMeshes += batch.sourceMeshes;
+    }
+    batches.clear();
+}
+
+
+void Model::loadBinary(const ModelBinary& binary)
+{
+    materials = binary.getMaterials();
+    sourceMeshes = binary.getSourceMeshCount();
+
+    // ModelConvert already merged the meshes per material
+    for (const auto& view : binary.getMeshes()) {
+        std::vector<Texture> textures;
+        for (const auto& ref : view.textures)
+            textures.push_back(loadTexture(ref.path, ref.type));
+
+        meshes.emplace_back(view.vertices, view.vertex_count, view.indices, view.index_count,
+                            textures, materials.at(view.material), view.material, compactVertices);
+    }
 }
 
 
@@ -52,7 +275,7 @@ void Model::processNode(aiNode* node, const aiScene* scene)
     // process all the node’s meshes (if exists)
     for (size_t i = 0; i < node->mNumMeshes; ++i) {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.emplace_back(std::move(processMesh(mesh, scene)));
+            processMesh(mesh, scene);
     }
 
     // then do the same for each of it's children
@@ -63,11 +286,14 @@ void Model::processNode(aiNode* node, const aiScene* scene)
 }
 
 
-Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
+void Model::processMesh(aiMesh* mesh, const aiScene* scene)
 {
-    std::vector<Vertex> vertices;
-    std::vector<uint> indices;
-    std::vector<Texture> textures;
+    // appended to the batch of its material, indices rebased onto the batch vertices
+    MeshBatch& batch = batches.at(mesh->mMaterialIndex);
+    std::vector<Vertex>& vertices = batch.vertices;
+    std::vector<uint>& indices = batch.indices;
+    std::vector<Texture>& textures = batch.textures;
+    const uint base = static_cast<uint>(vertices.size());
 
     // walk through each of the mesh's vertices
     for (size_t i = 0; i < mesh->mNumVertices; ++i) {
@@ -88,10 +314,11 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
     for (size_t i = 0; i < mesh->mNumFaces; ++i) {
             aiFace face = mesh->mFaces[i];
             for (size_t idx = 0; idx < face.mNumIndices; ++idx)
-                    indices.emplace_back(face.mIndices[idx]);
+                    indices.emplace_back(base + face.mIndices[idx]);
     }
 
-    if (mesh->mMaterialIndex >= 0) {
+    // textures depend on the material only: load them with its first mesh
+    if (batch.sourceMeshes++ == 0) {
             aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
             // 1. diffuse maps
             std::vector<Texture> diffuseMap = std::move(loadMaterialTextures(material, aiTextureType_DIFFUSE, tex_DIFFUSE));
@@ -106,146 +333,111 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
             std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, tex_HEIGHT);
             textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
     }
-
-    return std::move(Mesh{ vertices, indices, textures, materials.at(mesh->mMaterialIndex) });
 }
 
 
 MaterialInfo Model::processMaterial(aiMaterial* material)
 {
-    MaterialInfo mater;
-    aiString mname;
-    material->Get(AI_MATKEY_NAME, mname);
-    if (mname.length > 0)
-      mater.name = mname.C_Str();
+    return MaterialFromAssimp(material);
+}
 
-    int shadingModel;
-    material->Get(AI_MATKEY_SHADING_MODEL, shadingModel);
 
-    if(shadingModel != aiShadingMode_Phong && shadingModel != aiShadingMode_Gouraud){
-        /* Mesh shading model is not implemented in loader, set default material and light */
-        mater.name = "DefaultMaterial";
-    }
-    else{
-        aiColor3D dif(0.f, 0.f, 0.f);
-        aiColor3D amb(0.f, 0.f, 0.f);
-        aiColor3D spec(0.f, 0.f, 0.f);
-        float shine = 0.f;
 
-        material->Get(AI_MATKEY_COLOR_AMBIENT, amb);
-        material->Get(AI_MATKEY_COLOR_DIFFUSE, dif);
-        material->Get(AI_MATKEY_COLOR_SPECULAR, spec);
-        material->Get(AI_MATKEY_SHININESS, shine);
 
-        mater.ambient = glm::vec3(amb.r, amb.g, amb.b);
-        mater.diffuse = glm::vec3(dif.r, dif.g, dif.b);
-        mater.specular = glm::vec3(spec.r, spec.g, spec.b);
-        mater.shininess = shine;
 
-        mater.ambient *= 0.2f;
-        if(mater.shininess <= 0.f)
-          mater.shininess = 32.f; // default vaule
+std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, const TexType typeName)
+{
+    std::vector<Texture> texs;
 
+    for (size_t i = 0; i < mat->GetTextureCount(type); ++i) {
+          aiString str;
+          mat->GetTexture(type, i, &str);
+          texs.push_back(loadTexture(str.C_Str(), typeName));
     }
 
-
-    return mater;
+    return (texs);
 }
 
 
+Texture Model::loadTexture(const std::string& path, const TexType typeName)
+{
+    // skip, if texture is loaded earlier
+    for (size_t ti = 0; ti < textures_loaded.size(); ++ti) {
+            if (textures_loaded[ti].path == path)
+                    return textures_loaded[ti];
+    }
 
+    // name now, pixels after the meshes are built (decodePool is set for the whole load)
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    decodePool->submit(id, directory + '/' + path);
 
+    std::string name = std::move(TexGetNameByType(typeName));
+    textures_loaded.emplace_back(id, typeName, name, path);
+    return textures_loaded.back();
+}
 
-std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, const TexType typeName)
+
+void Model::initMaterialBuffer()
 {
-    std::vector<Texture> texs;
+    if (materials.empty())
+        return;
 
-    for (size_t i = 0; i < mat->GetTextureCount(type); ++i) {
-          aiString str;
-          mat->GetTexture(type, i, &str);
-          // skip, if texture is loaded earlier
-          bool skip = false;
-          for (size_t ti = 0; ti < textures_loaded.size(); ++ti) {
-                  if (std::strcmp(textures_loaded[ti].path.data(), str.C_Str()) == 0) {
-                          texs.push_back(textures_loaded[ti]);
-                          skip = true;
-                          break;
-                  }
-          }
-
-          if (!skip) {
-                  uint id = TextureFromFile(str.C_Str(), directory);
-                  std::string name = std::move(TexGetNameByType(typeName));
-                  texs.emplace_back(id, typeName, name, str.C_Str());
-                  textures_loaded.emplace_back(id, typeName, name, str.C_Str());
-          }
+    // std140 "Material" block, records at the uniform buffer offset alignment
+    GLint alignment = 16;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    materialStride = static_cast<GLint>((sizeof(MaterialBlock) + alignment - 1) / alignment * alignment);
+
+    std::vector<char> data(materials.size() * materialStride, 0);
+    for (size_t i = 0; i < materials.size(); ++i) {
+        const MaterialInfo& mater = materials[i];
+        MaterialBlock block = {
+            {mater.ambient.x, mater.ambient.y, mater.ambient.z, 1.f},
+            {mater.diffuse.x, mater.diffuse.y, mater.diffuse.z, 1.f},
+            {mater.specular.x, mater.specular.y, mater.specular.z, mater.shininess}
+        };
+        std::memcpy(&data[i * materialStride], &block, sizeof(block));
     }
 
-    return (texs);
+    glGenBuffers(1, &materialUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, materialUBO);
+    glBufferData(GL_UNIFORM_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 
 void Model::clearResource(){
     for(auto& mesh : meshes)
         mesh.clearBuffers();
+    if (materialUBO)
+        glDeleteBuffers(1, &materialUBO);
+    materialUBO = 0;
 }
 
 
 void Model::Draw(Shader& shader)
 {
-    if (!isInit)
-      return;
-
-    for(auto& mesh : meshes)
-      mesh.Draw(shader);
+    Draw(shader.getShaderProgram());
 }
 
 
-
-
-uint TextureFromFile(const char* path, const std::string& directory)
+void Model::Draw(const GLuint program, const GLsizei instances)
 {
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
-
-    uint textureID = 0;
-   
-    cv::Mat texturedata = cv::imread(path, cv::IMREAD_UNCHANGED);
-
-    if (texturedata.data){
-        int width = texturedata.cols, height = texturedata.rows, nrComponents = texturedata.channels();
-
-        const uchar* data = texturedata.data;
-
-        glGenTextures(1, &textureID);
-
-        GLenum internalformat = GL_RGB;
-        GLenum dataformat = GL_RGB;
-        if (nrComponents == 1)
-          internalformat = dataformat = GL_RED;
-        else if(nrComponents == 3){
-            internalformat = dataformat = GL_RGB;
-	    cv::cvtColor(texturedata, texturedata, cv::COLOR_BGR2RGB);
-	}
-        else if(nrComponents == 4){
-          internalformat = dataformat = GL_RGBA;
-	  cv::cvtColor(texturedata, texturedata, cv::COLOR_BGRA2RGBA);
-	}
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalformat, width, height, 0, dataformat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+    if (!isInit)
+      return;
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    }
-    else{
-        std::cerr << "Texture failed to load at path: " << path << "\n";
-        return 0;
+    // block binding is program state: set once per program
+    if (program != materialProgram) {
+        GLuint block = glGetUniformBlockIndex(program, "Material");
+        if (block != GL_INVALID_INDEX)
+            glUniformBlockBinding(program, block, MODEL_MATERIAL_BINDING);
+        materialProgram = program;
     }
 
-    return textureID;
+    for(auto& mesh : meshes) {
+        if (materialUBO)
+            glBindBufferRange(GL_UNIFORM_BUFFER, MODEL_MATERIAL_BINDING, materialUBO,
+                              mesh.getMaterialIndex() * materialStride, sizeof(MaterialBlock));
+        mesh.Draw(program, instances);
+    }
 }
-
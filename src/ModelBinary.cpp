@@ -0,0 +1,417 @@
+#include <ModelBinary.hpp>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+namespace {
+
+const char MODEL_MAGIC[8] = {'S', 'V', 'M', 'O', 'D', 'E', 'L', 0};
+
+static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex must be tightly packed for the binary model");
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t mesh_count;
+    uint32_t material_count;
+    uint32_t texture_count;
+    uint32_t source_mesh_count;
+    uint32_t reserved;
+    uint64_t source_size;
+    int64_t source_mtime_ns;
+    uint64_t string_offset;
+    uint64_t string_size;
+};
+
+struct MaterialRecord
+{
+    uint32_t name_offset;
+    uint32_t name_length;
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float shininess;
+};
+
+struct TextureRecord
+{
+    uint32_t type;
+    uint32_t path_offset;
+    uint32_t path_length;
+    uint32_t reserved;
+};
+
+// textures of a mesh are texture_count consecutive records from texture_first
+struct MeshRecord
+{
+    uint32_t material;
+    uint32_t texture_first;
+    uint32_t texture_count;
+    uint32_t reserved;
+    uint64_t vertex_offset;
+    uint64_t vertex_count;
+    uint64_t index_offset;
+    uint64_t index_count;
+};
+
+struct ImportedMesh
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint> indices;
+    uint32_t material;
+    std::vector<ModelBinary::TextureRef> textures;
+};
+
+
+bool sourceStamp(const std::string& path, uint64_t& size, int64_t& mtime_ns)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+
+uint32_t addString(std::string& strings, const std::string& str)
+{
+    auto offset = static_cast<uint32_t>(strings.size());
+    strings += str;
+    return offset;
+}
+
+
+// same texture slots as Model::processMesh
+void collectTextures(aiMaterial* mat, aiTextureType type, const TexType typeName,
+                     std::vector<ModelBinary::TextureRef>& textures)
+{
+    for (size_t i = 0; i < mat->GetTextureCount(type); ++i) {
+        aiString str;
+        mat->GetTexture(type, i, &str);
+        textures.push_back({typeName, str.C_Str()});
+    }
+}
+
+
+// same traversal order as Model::processNode
+void collectMeshes(aiNode* node, const aiScene* scene, std::vector<ImportedMesh>& meshes)
+{
+    for (size_t i = 0; i < node->mNumMeshes; ++i) {
+        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+        ImportedMesh out;
+
+        out.vertices.reserve(mesh->mNumVertices);
+        for (size_t v = 0; v < mesh->mNumVertices; ++v) {
+            glm::vec3 position{mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z};
+            glm::vec3 normal(0.f);
+            if (mesh->HasNormals())
+                normal = glm::vec3{mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z};
+            glm::vec2 texturecoord(0.f, 0.f);
+            if (mesh->mTextureCoords[0])
+                texturecoord = glm::vec2{mesh->mTextureCoords[0][v].x, mesh->mTextureCoords[0][v].y};
+            out.vertices.emplace_back(position, normal, texturecoord);
+        }
+
+        for (size_t f = 0; f < mesh->mNumFaces; ++f) {
+            const aiFace& face = mesh->mFaces[f];
+            for (size_t idx = 0; idx < face.mNumIndices; ++idx)
+                out.indices.push_back(face.mIndices[idx]);
+        }
+
+        out.material = mesh->mMaterialIndex;
+        aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+        collectTextures(material, aiTextureType_DIFFUSE, tex_DIFFUSE, out.textures);
+        collectTextures(material, aiTextureType_SPECULAR, tex_SPECULAR, out.textures);
+        collectTextures(material, aiTextureType_HEIGHT, tex_NORMAL, out.textures);
+        collectTextures(material, aiTextureType_AMBIENT, tex_HEIGHT, out.textures);
+
+        meshes.emplace_back(std::move(out));
+    }
+
+    for (size_t i = 0; i < node->mNumChildren; ++i)
+        collectMeshes(node->mChildren[i], scene, meshes);
+}
+
+}
+
+
+MaterialInfo MaterialFromAssimp(aiMaterial* material)
+{
+    MaterialInfo mater;
+    aiString mname;
+    material->Get(AI_MATKEY_NAME, mname);
+    if (mname.length > 0)
+      mater.name = mname.C_Str();
+
+    int shadingModel;
+    material->Get(AI_MATKEY_SHADING_MODEL, shadingModel);
+
+    if(shadingModel != aiShadingMode_Phong && shadingModel != aiShadingMode_Gouraud){
+        /* Mesh shading model is not implemented in loader, set default material and light */
+        mater.name = "DefaultMaterial";
+    }
+    else{
+        aiColor3D dif(0.f, 0.f, 0.f);
+        aiColor3D amb(0.f, 0.f, 0.f);
+        aiColor3D spec(0.f, 0.f, 0.f);
+        float shine = 0.f;
+
+        material->Get(AI_MATKEY_COLOR_AMBIENT, amb);
+        material->Get(AI_MATKEY_COLOR_DIFFUSE, dif);
+        material->Get(AI_MATKEY_COLOR_SPECULAR, spec);
+        material->Get(AI_MATKEY_SHININESS, shine);
+
+        mater.ambient = glm::vec3(amb.r, amb.g, amb.b);
+        mater.diffuse = glm::vec3(dif.r, dif.g, dif.b);
+        mater.specular = glm::vec3(spec.r, spec.g, spec.b);
+        mater.shininess = shine;
+
+        mater.ambient *= 0.2f;
+        if(mater.shininess <= 0.f)
+          mater.shininess = 32.f; // default vaule
+
+    }
+
+
+    return mater;
+}
+
+
+bool ModelBinary::convert(const std::string& model_path, const std::string& binary_path)
+{
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    if (!sourceStamp(model_path, header.source_size, header.source_mtime_ns)) {
+        std::cerr << "ModelBinary: cannot stat " << model_path << "\n";
+        return false;
+    }
+
+    Assimp::Importer import_;
+    const aiScene* scene = import_.ReadFile(model_path, MODEL_IMPORT_FLAGS);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        std::cerr << "Error Assimp: " << import_.GetErrorString() << "\n";
+        return false;
+    }
+
+    std::vector<ImportedMesh> source;
+    collectMeshes(scene->mRootNode, scene, source);
+
+    // merge per material (textures depend on the material only), as Model does for Assimp
+    std::vector<ImportedMesh> merged(scene->mNumMaterials);
+    for (auto& mesh : source) {
+        ImportedMesh& batch = merged.at(mesh.material);
+        const uint base = static_cast<uint>(batch.vertices.size());
+        if (batch.vertices.empty()) {
+            batch.material = mesh.material;
+            batch.textures = mesh.textures;
+        }
+        batch.vertices.insert(batch.vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        for (uint idx : mesh.indices)
+            batch.indices.push_back(base + idx);
+    }
+
+    std::vector<ImportedMesh> imported;
+    for (auto& batch : merged) {
+        if (!batch.indices.empty())
+            imported.emplace_back(std::move(batch));
+    }
+
+    std::string strings;
+    std::vector<MaterialRecord> material_records(scene->mNumMaterials);
+    for (size_t i = 0; i < scene->mNumMaterials; ++i) {
+        MaterialInfo mater = MaterialFromAssimp(scene->mMaterials[i]);
+        MaterialRecord& rec = material_records[i];
+        rec.name_offset = addString(strings, mater.name);
+        rec.name_length = static_cast<uint32_t>(mater.name.size());
+        std::memcpy(rec.ambient, &mater.ambient[0], sizeof(rec.ambient));
+        std::memcpy(rec.diffuse, &mater.diffuse[0], sizeof(rec.diffuse));
+        std::memcpy(rec.specular, &mater.specular[0], sizeof(rec.specular));
+        rec.shininess = mater.shininess;
+    }
+
+    std::vector<TextureRecord> texture_records;
+    std::vector<MeshRecord> mesh_records(imported.size());
+    for (size_t i = 0; i < imported.size(); ++i) {
+        MeshRecord& rec = mesh_records[i];
+        std::memset(&rec, 0, sizeof(rec));
+        rec.material = imported[i].material;
+        rec.texture_first = static_cast<uint32_t>(texture_records.size());
+        rec.texture_count = static_cast<uint32_t>(imported[i].textures.size());
+        for (const auto& tex : imported[i].textures) {
+            TextureRecord trec;
+            std::memset(&trec, 0, sizeof(trec));
+            trec.type = tex.type;
+            trec.path_offset = addString(strings, tex.path);
+            trec.path_length = static_cast<uint32_t>(tex.path.size());
+            texture_records.push_back(trec);
+        }
+    }
+
+    // header, tables, strings, then the aligned vertex and index arrays
+    std::memcpy(header.magic, MODEL_MAGIC, sizeof(MODEL_MAGIC));
+    header.version = VERSION;
+    header.mesh_count = static_cast<uint32_t>(mesh_records.size());
+    header.material_count = static_cast<uint32_t>(material_records.size());
+    header.texture_count = static_cast<uint32_t>(texture_records.size());
+    header.source_mesh_count = static_cast<uint32_t>(source.size());
+
+    size_t offset = sizeof(FileHeader) + material_records.size() * sizeof(MaterialRecord)
+                  + texture_records.size() * sizeof(TextureRecord) + mesh_records.size() * sizeof(MeshRecord);
+    header.string_offset = offset;
+    header.string_size = strings.size();
+    offset += strings.size();
+
+    for (size_t i = 0; i < imported.size(); ++i) {
+        offset = AtomicFileWriter::alignUp(offset);
+        mesh_records[i].vertex_offset = offset;
+        mesh_records[i].vertex_count = imported[i].vertices.size();
+        offset += imported[i].vertices.size() * sizeof(Vertex);
+
+        offset = AtomicFileWriter::alignUp(offset);
+        mesh_records[i].index_offset = offset;
+        mesh_records[i].index_count = imported[i].indices.size();
+        offset += imported[i].indices.size() * sizeof(uint);
+    }
+
+    AtomicFileWriter out(binary_path);
+    if (!out.isOpen()) {
+        std::cerr << "ModelBinary: cannot write " << out.getTmpPath() << "\n";
+        return false;
+    }
+
+    out.write(&header, sizeof(header));
+    out.write(material_records.data(), material_records.size() * sizeof(MaterialRecord));
+    out.write(texture_records.data(), texture_records.size() * sizeof(TextureRecord));
+    out.write(mesh_records.data(), mesh_records.size() * sizeof(MeshRecord));
+    out.write(strings.data(), strings.size());
+
+    for (size_t i = 0; i < imported.size(); ++i) {
+        out.padTo(mesh_records[i].vertex_offset);
+        out.write(imported[i].vertices.data(), imported[i].vertices.size() * sizeof(Vertex));
+        out.padTo(mesh_records[i].index_offset);
+        out.write(imported[i].indices.data(), imported[i].indices.size() * sizeof(uint));
+    }
+
+    if (!out.commit()) {
+        std::cerr << "ModelBinary: write failed for " << binary_path << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool ModelBinary::load(const std::string& binary_path, const std::string& model_path)
+{
+    release();
+
+    uint64_t source_size = 0;
+    int64_t source_mtime_ns = 0;
+    if (!sourceStamp(model_path, source_size, source_mtime_ns))
+        return false;
+
+    if (!file.open(binary_path, sizeof(FileHeader), MODEL_MAGIC, sizeof(MODEL_MAGIC)))
+        return false;
+
+    const size_t file_size = file.size();
+    const uint8_t* base = file.data();
+    const auto* header = reinterpret_cast<const FileHeader*>(base);
+
+    const size_t tables_end = sizeof(FileHeader) + header->material_count * sizeof(MaterialRecord)
+                            + header->texture_count * sizeof(TextureRecord) + header->mesh_count * sizeof(MeshRecord);
+
+    if (header->version != VERSION ||
+        header->source_size != source_size || header->source_mtime_ns != source_mtime_ns ||
+        tables_end > file_size || header->string_offset + header->string_size > file_size) {
+        std::cout << "ModelBinary: " << binary_path << " is stale, loading " << model_path << " with Assimp\n";
+        release();
+        return false;
+    }
+
+    source_meshes = header->source_mesh_count;
+
+    const auto* material_records = reinterpret_cast<const MaterialRecord*>(base + sizeof(FileHeader));
+    const auto* texture_records = reinterpret_cast<const TextureRecord*>(material_records + header->material_count);
+    const auto* mesh_records = reinterpret_cast<const MeshRecord*>(texture_records + header->texture_count);
+    const char* strings = reinterpret_cast<const char*>(base + header->string_offset);
+
+    auto string_at = [&](const uint32_t offset, const uint32_t length, std::string& str) {
+        if (static_cast<uint64_t>(offset) + length > header->string_size)
+            return false;
+        str.assign(strings + offset, length);
+        return true;
+    };
+
+    bool valid = true;
+
+    for (uint32_t i = 0; i < header->material_count && valid; ++i) {
+        const MaterialRecord& rec = material_records[i];
+        MaterialInfo mater(glm::vec3(rec.ambient[0], rec.ambient[1], rec.ambient[2]),
+                           glm::vec3(rec.diffuse[0], rec.diffuse[1], rec.diffuse[2]),
+                           glm::vec3(rec.specular[0], rec.specular[1], rec.specular[2]),
+                           rec.shininess);
+        valid = string_at(rec.name_offset, rec.name_length, mater.name);
+        materials.push_back(mater);
+    }
+
+    for (uint32_t i = 0; i < header->mesh_count && valid; ++i) {
+        const MeshRecord& rec = mesh_records[i];
+        if (rec.material >= header->material_count ||
+            static_cast<uint64_t>(rec.texture_first) + rec.texture_count > header->texture_count ||
+            rec.vertex_offset + rec.vertex_count * sizeof(Vertex) > file_size ||
+            rec.index_offset + rec.index_count * sizeof(uint) > file_size) {
+            valid = false;
+            break;
+        }
+
+        // indices go to glDrawElements unchecked, all of them must address this mesh's vertices
+        const auto* indices = reinterpret_cast<const uint*>(base + rec.index_offset);
+        if (rec.index_count > 0 && *std::max_element(indices, indices + rec.index_count) >= rec.vertex_count) {
+            valid = false;
+            break;
+        }
+
+        MeshView view;
+        view.vertices = reinterpret_cast<const Vertex*>(base + rec.vertex_offset);
+        view.vertex_count = rec.vertex_count;
+        view.indices = indices;
+        view.index_count = rec.index_count;
+        view.material = rec.material;
+
+        for (uint32_t t = 0; t < rec.texture_count && valid; ++t) {
+            const TextureRecord& trec = texture_records[rec.texture_first + t];
+            TextureRef ref;
+            ref.type = static_cast<TexType>(trec.type);
+            valid = trec.type <= tex_UNKNOWN && string_at(trec.path_offset, trec.path_length, ref.path);
+            view.textures.push_back(ref);
+        }
+
+        meshes.push_back(view);
+    }
+
+    if (!valid) {
+        std::cerr << "ModelBinary: " << binary_path << " is corrupt, loading " << model_path << " with Assimp\n";
+        release();
+        return false;
+    }
+
+    return true;
+}
+
+
+void ModelBinary::release()
+{
+    file.release();
+    meshes.clear();
+    materials.clear();
+    source_meshes = 0;
+}
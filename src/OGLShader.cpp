@@ -1,7 +1,41 @@
 #include "SVRenderSimple.hpp"
+#include "Shader.hpp"  // queryUniformLocations
+#include "MappedFile.hpp"
 #include <GLES3/gl3.h>
 #include <GLES3/gl3ext.h>
 #include <GLFW/glfw3.h>
+#include <sys/stat.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const char BINARY_MAGIC[8] = { 'S', 'V', 'P', 'R', 'O', 'G', 0, 0 };
+
+struct BinaryHeader {
+    char magic[8];
+    uint32_t format;
+    uint32_t length;
+};
+
+// FNV-1a, 64 bit
+uint64_t hashBytes(uint64_t hash, const std::string& data) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* str = glGetString(name);
+    return str ? reinterpret_cast<const char*>(str) : "";
+}
+
+} // namespace
 
 OGLShader::OGLShader() : ID(0) {
 }
@@ -16,10 +50,12 @@ OGLShader::~OGLShader() {
     }
 }
 
-bool OGLShader::loadFromFile(const std::string& vertexPath, const std::string& fragmentPath) {
+bool OGLShader::loadFromFile(const std::string& vertexPath, const std::string& fragmentPath,
+                             const std::string& defines, const std::string& vertexPreludePath) {
     // 1. Retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
     std::string fragmentCode;
+    std::string preludeCode;
     std::ifstream vShaderFile;
     std::ifstream fShaderFile;
     
@@ -44,15 +80,41 @@ bool OGLShader::loadFromFile(const std::string& vertexPath, const std::string& f
         // Convert stream into string
         vertexCode = vShaderStream.str();
         fragmentCode = fShaderStream.str();
+        
+        if (!vertexPreludePath.empty()) {
+            std::ifstream preludeFile;
+            preludeFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            preludeFile.open(vertexPreludePath);
+            std::stringstream preludeStream;
+            preludeStream << preludeFile.rdbuf();
+            preludeCode = preludeStream.str();
+        }
     }
     catch (std::ifstream::failure& e) {
         std::cerr << "ERROR: Shader file not successfully read" << std::endl;
         std::cerr << "  Vertex: " << vertexPath << std::endl;
         std::cerr << "  Fragment: " << fragmentPath << std::endl;
+        if (!vertexPreludePath.empty()) {
+            std::cerr << "  Vertex prelude: " << vertexPreludePath << std::endl;
+        }
         std::cerr << "  Error: " << e.what() << std::endl;
         return false;
     }
     
+    insertDefines(vertexCode, defines + preludeCode);
+    insertDefines(fragmentCode, defines);
+    
+    if (ID != 0) {
+        glDeleteProgram(ID);
+        ID = 0;
+    }
+    
+    const std::string cachePath = binaryCachePath(vertexCode, fragmentCode);
+    if (!cachePath.empty() && loadProgramBinary(cachePath)) {
+        queryUniformLocations(ID, uniform_locations);
+        return true;
+    }
+    
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
     
@@ -82,6 +144,9 @@ bool OGLShader::loadFromFile(const std::string& vertexPath, const std::string& f
     ID = glCreateProgram();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
+    if (!cachePath.empty()) {
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(ID);
     if (!checkCompileErrors(ID, "PROGRAM", "")) {
         glDeleteShader(vertex);
@@ -95,9 +160,112 @@ bool OGLShader::loadFromFile(const std::string& vertexPath, const std::string& f
     glDeleteShader(vertex);
     glDeleteShader(fragment);
     
+    if (!cachePath.empty()) {
+        saveProgramBinary(cachePath);
+    }
+    
+    // Resolve every uniform location once
+    queryUniformLocations(ID, uniform_locations);
+    
     return true;
 }
 
+void OGLShader::insertDefines(std::string& code, const std::string& defines) {
+    if (defines.empty()) {
+        return;
+    }
+    
+    size_t pos = 0;
+    if (code.compare(0, 8, "#version") == 0) {
+        pos = code.find('\n');
+        pos = (pos == std::string::npos) ? code.size() : pos + 1;
+    }
+    code.insert(pos, defines);
+}
+
+std::string OGLShader::binaryCachePath(const std::string& vertexCode, const std::string& fragmentCode) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        return "";
+    }
+    
+    // A driver update invalidates the binaries, so it is part of the key
+    uint64_t hash = 14695981039346656037ull;
+    for (const std::string& part : { vertexCode, fragmentCode, glString(GL_VENDOR),
+                                     glString(GL_RENDERER), glString(GL_VERSION) }) {
+        hash = hashBytes(hash, part);
+        hash = hashBytes(hash, std::string(1, '\0'));
+    }
+    
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+    return std::string(SHADER_CACHE_DIR) + "/" + name;
+}
+
+bool OGLShader::loadProgramBinary(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    
+    BinaryHeader header;
+    std::vector<char> binary;
+    if (in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0) {
+        binary.resize(header.length);
+        in.read(binary.data(), binary.size());
+    }
+    
+    if (binary.empty() || !in) {
+        std::cerr << "Warning: invalid shader cache entry " << path << std::endl;
+        return false;
+    }
+    
+    ID = glCreateProgram();
+    glProgramBinary(ID, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    
+    GLint success = 0;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success) {
+        // Binary from another driver build: fall back to the sources
+        std::cout << "Shader cache entry " << path << " rejected by the driver, recompiling" << std::endl;
+        glDeleteProgram(ID);
+        ID = 0;
+        return false;
+    }
+    
+    std::cout << "Shader program loaded from cache: " << path << std::endl;
+    return true;
+}
+
+void OGLShader::saveProgramBinary(const std::string& path) const {
+    GLint length = 0;
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(ID, length, &length, &format, binary.data());
+    
+    BinaryHeader header;
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+    
+    mkdir(SHADER_CACHE_DIR, 0755);
+    
+    AtomicFileWriter out(path);
+    out.write(&header, sizeof(header));
+    out.write(binary.data(), length);
+    
+    if (!out.commit()) {
+        std::cerr << "Warning: cannot write shader cache entry " << path << std::endl;
+    }
+}
+
 void OGLShader::useProgramm() const {
     glUseProgram(ID);
 }
@@ -106,52 +274,97 @@ void OGLShader::use() const {
     glUseProgram(ID);
 }
 
+GLint OGLShader::getUniformLocation(const std::string& name) const {
+    auto it = uniform_locations.find(name);
+    if (it != uniform_locations.end()) {
+        return it->second;
+    }
+    
+    // Not an active uniform (e.g. optimized out or an array element): remember the result too
+    const GLint location = glGetUniformLocation(ID, name.c_str());
+    uniform_locations.emplace(name, location);
+    return location;
+}
+
+bool OGLShader::bindUniformBlock(const char* name, GLuint binding) const {
+    const GLuint block = glGetUniformBlockIndex(ID, name);
+    if (block == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(ID, block, binding);
+    return true;
+}
+
 void OGLShader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void OGLShader::setInt(const std::string &name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(getUniformLocation(name), value);
 }
 
 void OGLShader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void OGLShader::setVec2(const std::string &name, const glm::vec2 &value) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void OGLShader::setVec2(const std::string &name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    glUniform2f(getUniformLocation(name), x, y);
 }
 
 void OGLShader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void OGLShader::setVec3(const std::string &name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void OGLShader::setVec4(const std::string &name, const glm::vec4 &value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void OGLShader::setVec4(const std::string &name, float x, float y, float z, float w) const {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void OGLShader::setMat2(const std::string &name, const glm::mat2 &mat) const {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void OGLShader::setMat3(const std::string &name, const glm::mat3 &mat) const {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void OGLShader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+void OGLShader::setInt(GLint location, int value) const {
+    glUniform1i(location, value);
+}
+
+void OGLShader::setFloat(GLint location, float value) const {
+    glUniform1f(location, value);
+}
+
+void OGLShader::setVec2(GLint location, float x, float y) const {
+    glUniform2f(location, x, y);
+}
+
+void OGLShader::setVec3(GLint location, float x, float y, float z) const {
+    glUniform3f(location, x, y, z);
+}
+
+void OGLShader::setVec4(GLint location, float x, float y, float z, float w) const {
+    glUniform4f(location, x, y, z, w);
+}
+
+void OGLShader::setMat4(GLint location, const glm::mat4 &mat) const {
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
 }
 
 bool OGLShader::checkCompileErrors(unsigned int shader, const std::string& type, const std::string& path) {
@@ -1,19 +1,24 @@
 #include "SVAppSimple.hpp"
 #include <iostream>
-#include <thread>
 #include <chrono>
 
 using namespace std::chrono_literals;
 
-SVAppSimple::SVAppSimple() : is_running(false) {
+SVAppSimple::SVAppSimple()
+    : capture_queue(PIPELINE_QUEUE_DEPTH), frame_scheduler(PIPELINE_TARGET_FPS),
+      is_direct(false), rendered_frames(0), stream_failed(false),
+      shm_failed(false), shm_pinned(false),
+      brightness_tracker(NUM_CAMERAS, GAIN_DRIFT_THRESHOLD, GAIN_MIN_UPDATE_INTERVAL_MS),
+      is_running(false), is_headless(false) {
 }
 
 SVAppSimple::~SVAppSimple() {
     stop();
 }
 
-bool SVAppSimple::init(const std::string& calib_folder) {
+bool SVAppSimple::init(const std::string& calib_folder, bool headless) {
     calibration_folder = calib_folder;
+    is_headless = headless;
     
     std::cout << "\n========================================" << std::endl;
     std::cout << "Initializing Simple Surround View System" << std::endl;
@@ -24,7 +29,11 @@ bool SVAppSimple::init(const std::string& calib_folder) {
     // ========================================
     std::cout << "[1/4] Initializing camera source..." << std::endl;
     
-    camera_source = std::make_shared<MultiCameraSource>();
+    if (SHM_INPUT) {
+        camera_source = std::make_shared<SharedMemoryCameraSource>(SHM_INPUT_PREFIX);
+    } else {
+        camera_source = std::make_shared<MultiCameraSource>();
+    }
     camera_source->setFrameSize(cv::Size(CAMERA_WIDTH, CAMERA_HEIGHT));
     
     // Initialize without undistortion
@@ -113,7 +122,7 @@ bool SVAppSimple::init(const std::string& calib_folder) {
     // ========================================
     std::cout << "\n[4/4] Initializing renderer..." << std::endl;
     
-    renderer = std::make_shared<SVRenderSimple>(OUTPUT_WIDTH, OUTPUT_HEIGHT);
+    renderer = std::make_shared<SVRenderSimple>(OUTPUT_WIDTH, OUTPUT_HEIGHT, is_headless);
     
     if (!renderer->init(
         "models/Dodge Challenger SRT Hellcat 2015.obj",
@@ -125,8 +134,43 @@ bool SVAppSimple::init(const std::string& calib_folder) {
         return false;
     }
     
+    if (RENDER_DIRECT_PROJECTION) {
+        std::vector<std::vector<float>> projections(renderer->getBowlLodCount());
+        is_direct = true;
+        for (int i = 0; i < renderer->getBowlLodCount() && is_direct; i++) {
+            is_direct = stitcher->computeBowlProjection(renderer->getBowlVertices(i),
+                                                        SVRenderSimple::BOWL_VERTEX_STRIDE,
+                                                        SVRenderSimple::BOWL_UV_OFFSET, projections[i]);
+        }
+        is_direct = is_direct &&
+                    renderer->setupDirectProjection(projections,
+                                                    "shaders/surroundshaderdirectvert.glsl",
+                                                    "shaders/surroundshaderdirectfrag.glsl");
+        if (!is_direct) {
+            std::cerr << "WARNING: Direct projection unavailable, rendering the stitched panorama" << std::endl;
+        }
+    }
+    
+    if (RENDER_MULTIVIEW) {
+        renderer->setupMultiView("shaders/cameratilevert.glsl", "shaders/cameratilefrag.glsl");
+    }
+    
     std::cout << "  ✓ Renderer ready" << std::endl;
     
+    if (STREAM_OUTPUT != 0) {
+        stream_output = std::make_unique<SVStreamOutput>();
+        if (STREAM_OUTPUT == 1) {
+            // Rendered frames arrive on the render thread, a few frames after drawing
+            renderer->setReadbackCallback([this](const cv::Mat& bgra, unsigned long) {
+                streamFrame(bgra, true);
+            });
+        }
+    }
+    
+    if (SHM_OUTPUT) {
+        shm_publisher = std::make_unique<SVShmFramePublisher>();
+    }
+    
     // ========================================
     // Initialization Complete
     // ========================================
@@ -136,9 +180,19 @@ bool SVAppSimple::init(const std::string& calib_folder) {
     std::cout << "\nConfiguration:" << std::endl;
     std::cout << "  Cameras: " << NUM_CAMERAS << std::endl;
     std::cout << "  Input resolution: " << CAMERA_WIDTH << "x" << CAMERA_HEIGHT << std::endl;
+    std::cout << "  Camera source: " << (SHM_INPUT ? "shared memory " SHM_INPUT_PREFIX "*" : "Ethernet H.264") << std::endl;
     std::cout << "  Output resolution: " << OUTPUT_WIDTH << "x" << OUTPUT_HEIGHT << std::endl;
     std::cout << "  Blend bands: " << NUM_BLEND_BANDS << std::endl;
     std::cout << "  Process scale: " << PROCESS_SCALE << std::endl;
+    std::cout << "  Display: " << (is_headless ? "headless (EGL offscreen)" : "window") << std::endl;
+    std::cout << "  Bowl texture: " << (is_direct ? "direct camera projection" : "stitched panorama") << std::endl;
+    if (stream_output) {
+        std::cout << "  Output stream: " << (STREAM_OUTPUT == 1 ? "rendered view" : "stitched canvas")
+                  << " -> " << STREAM_TARGET << std::endl;
+    }
+    if (shm_publisher) {
+        std::cout << "  Shared memory ring: " << SHM_OUTPUT_NAME << " (" << SHM_OUTPUT_SLOTS << " slots)" << std::endl;
+    }
     std::cout << "\nPress Ctrl+C to exit\n" << std::endl;
     
     is_running = true;
@@ -151,20 +205,36 @@ void SVAppSimple::run() {
         return;
     }
     
-    auto last_gain_update = std::chrono::steady_clock::now();
-    const auto gain_update_interval = std::chrono::seconds(GAIN_UPDATE_INTERVAL);
-    
-    int frame_count = 0;
-    auto start_time = std::chrono::steady_clock::now();
-    auto last_fps_time = start_time;
+    // Hand the GL context over to the render thread, then start the stages downstream first
+    renderer->detachContext();
+    render_thread = std::thread(&SVAppSimple::renderLoop, this);
+    stitch_thread = std::thread(&SVAppSimple::stitchLoop, this);
+    capture_thread = std::thread(&SVAppSimple::captureLoop, this);
     
-    std::cout << "Starting main loop..." << std::endl;
+    std::cout << "Starting pipeline (capture -> stitch -> render, queue depth "
+              << PIPELINE_QUEUE_DEPTH << ", target " << PIPELINE_TARGET_FPS << " FPS)..." << std::endl;
     
+    // Window events stay on the thread that created the window
     while (is_running && !renderer->shouldClose()) {
-        // Capture frames
+        renderer->waitEvents(PIPELINE_EVENT_TIMEOUT_MS);
+    }
+    
+    is_running = false;
+    joinPipeline();
+    
+    std::cout << "\nMain loop exited" << std::endl;
+}
+
+void SVAppSimple::captureLoop() {
+    using Clock = SVStageMetrics::Clock;
+    
+    while (is_running) {
+        // Blocks in the source until every camera delivered a frame
+        auto wait_start = Clock::now();
         if (!camera_source->capture(frames)) {
             std::cerr << "WARNING: Frame capture failed" << std::endl;
-            std::this_thread::sleep_for(1ms);
+            // An earlier retry could not make it into the next output slot anyway
+            std::this_thread::sleep_for(frame_scheduler.getPeriod());
             continue;
         }
         
@@ -179,59 +249,326 @@ void SVAppSimple::run() {
         }
         
         if (!all_valid) {
-            std::this_thread::sleep_for(1ms);
+            std::this_thread::sleep_for(frame_scheduler.getPeriod());
             continue;
         }
         
-        // Prepare frame vector for stitcher
-        std::vector<cv::cuda::GpuMat> gpu_frames;
+        auto captured = Clock::now();
+        capture_metrics.addInputWait(captured - wait_start);
+        
+        // Back-pressure: wait for the stitch stage to free a slot
+        SVCaptureSet* set = capture_queue.writeSlot();
+        while (!set && is_running) {
+            capture_queue.waitWritable(100ms);
+            set = capture_queue.writeSlot();
+        }
+        if (!set) {
+            break;
+        }
+        
+        auto copy_start = Clock::now();
+        capture_metrics.addOutputWait(copy_start - captured);
+        
+        // Source buffers are reused by the next capture, the queue gets copies
         for (int i = 0; i < NUM_CAMERAS; i++) {
-            gpu_frames.push_back(frames[i].gpuFrame);
+            frames[i].gpuFrame.copyTo(set->cameras[i]);
         }
+        set->captured = captured;
+        capture_queue.push();
         
-        // Stitch
-        if (!stitcher->stitch(gpu_frames, stitched_output)) {
-            std::cerr << "WARNING: Stitching failed" << std::endl;
+        capture_metrics.addWork(Clock::now() - copy_start);
+        capture_metrics.addFrame();
+    }
+}
+
+void SVAppSimple::stitchLoop() {
+    using Clock = SVStageMetrics::Clock;
+    
+    std::vector<double> lumas;
+    std::vector<cv::cuda::GpuMat> gpu_frames(NUM_CAMERAS);
+    
+    int frame_count = 0;
+    unsigned long last_rendered = 0;
+    auto last_fps_time = Clock::now();
+    auto last_stats_time = last_fps_time;
+    
+    while (is_running) {
+        auto wait_start = Clock::now();
+        SVCaptureSet* set = capture_queue.readSlot();
+        if (!set) {
+            capture_queue.waitReadable(100ms);
+            stitch_metrics.addInputWait(Clock::now() - wait_start);
             continue;
         }
         
-        // Periodic gain update
-        auto now = std::chrono::steady_clock::now();
-        if (now - last_gain_update >= gain_update_interval) {
-            std::cout << "Updating gain compensation..." << std::endl;
-            stitcher->recomputeGain(gpu_frames);
-            last_gain_update = now;
+        // More than a slot behind: only the newest queued frame set is worth stitching.
+        // On schedule, queued sets are stitched in order (PIPELINE_QUEUE_DEPTH absorbs jitter)
+        unsigned long stale = 0;
+        while (capture_queue.size() > 1 && frame_scheduler.isBehind(Clock::now())) {
+            capture_queue.pop();
+            stale++;
+        }
+        if (stale > 0) {
+            frame_scheduler.addSkippedStale(stale);
+            set = capture_queue.readSlot();
         }
         
-        // Render
-        if (!renderer->render(stitched_output)) {
-            std::cerr << "ERROR: Rendering failed" << std::endl;
-            break;
+        auto now = Clock::now();
+        stitch_metrics.addInputWait(now - wait_start);
+        
+        // Ahead of the target rate: leave this set, a newer one fills the slot
+        if (!frame_scheduler.admit(now)) {
+            capture_queue.pop();
+            continue;
         }
         
-        // FPS calculation and display
+        auto captured = set->captured;
+        for (int i = 0; i < NUM_CAMERAS; i++) {
+            gpu_frames[i] = set->cameras[i];
+        }
+        
+        bool stats_fresh = false;
+        bool stitched = true;
+        SVRenderFrame& slot = frame_mailbox.writeSlot();
+        
+        if (is_direct) {
+            // The render thread gets its own copies, the capture slot is reused
+            for (int i = 0; i < NUM_CAMERAS; i++) {
+                set->cameras[i].copyTo(slot.cameras[i]);
+                slot.gains[i] = static_cast<float>(stitcher->getGain(i));
+            }
+            frame_mailbox.publish();
+            
+            // Exposure statistics only need a stitch at the gain update rate
+            if (now - last_stats_time >= std::chrono::milliseconds(GAIN_MIN_UPDATE_INTERVAL_MS)) {
+                stats_fresh = stitcher->stitch(gpu_frames, stats_output);
+                last_stats_time = now;
+                
+                if (stats_fresh && STREAM_OUTPUT == 2) {
+                    stats_output.download(stream_canvas);
+                    streamFrame(stream_canvas, false);
+                }
+                if (stats_fresh && shm_publisher) {
+                    publishShared(stats_output, captured);
+                }
+            }
+        } else if (stitcher->stitch(gpu_frames, slot.stitched)) {
+            // Stitch straight into the mailbox slot and hand it to the render thread
+            if (STREAM_OUTPUT == 2) {
+                slot.stitched.download(stream_canvas);
+                streamFrame(stream_canvas, false);
+            }
+            if (shm_publisher) {
+                publishShared(slot.stitched, captured);
+            }
+            frame_mailbox.publish();
+            stats_fresh = true;
+        } else {
+            std::cerr << "WARNING: Stitching failed" << std::endl;
+            stitched = false;
+        }
+        
+        capture_queue.pop();
+        if (stitched) {
+            frame_scheduler.complete(captured, Clock::now());
+            frame_scheduler.notifyFrame();
+        }
+        
+        // Gain update when camera brightness drifts
+        if (stats_fresh && stitcher->measureLuma(lumas) && brightness_tracker.update(lumas, now)) {
+            std::cout << "Brightness drift " << brightness_tracker.getMaxDrift() * 100.0f
+                      << "%, updating gain compensation..." << std::endl;
+            stitcher->recomputeGain();
+        }
+        
+        stitch_metrics.addWork(Clock::now() - now);
+        if (!stitched) {
+            continue;
+        }
+        stitch_metrics.addFrame();
+        
         frame_count++;
+        
+        // FPS calculation and display
         if (frame_count % 30 == 0) {
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
                 now - last_fps_time).count();
             
             if (elapsed > 0) {
                 float fps = (30.0f * 1000.0f) / elapsed;
-                std::cout << "FPS: " << fps << std::endl;
+                unsigned long rendered = rendered_frames.load();
+                float render_fps = ((rendered - last_rendered) * 1000.0f) / elapsed;
+                last_rendered = rendered;
+                
+                std::cout << "Stitch FPS: " << fps
+                          << " | Render FPS: " << render_fps
+                          << " (dropped " << frame_mailbox.getDroppedCount()
+                          << ", repeated " << frame_mailbox.getRepeatedCount() << ")"
+                          << " | Render: " << renderer->getLastRenderTimeMs() << " ms"
+                          << " (upload " << renderer->getLastUploadTimeMs() << " ms, "
+                          << renderer->getUploadStallCount() << " stalls)"
+                          << " | Bowl LOD " << renderer->getLastBowlLod()
+                          << ": " << renderer->getLastBowlVertexCount() << " vertices"
+                          << " | Gain updates: " << brightness_tracker.getUpdateCount()
+                          << " (rate limited: " << brightness_tracker.getSuppressedCount() << ")"
+                          << " | Brightness drift: " << brightness_tracker.getMaxDrift() * 100.0f << "%";
+                if (stream_output && stream_output->isOpen()) {
+                    std::cout << " | Stream " << stream_output->getEncoderName()
+                              << ": encode " << stream_output->getLastEncodeLatencyMs() << " ms"
+                              << " (mean " << stream_output->getMeanEncodeLatencyMs() << " ms, dropped "
+                              << stream_output->getDroppedCount() << ")";
+                }
+                std::cout << std::endl;
+                
+                printPipelineStats();
             }
             
             last_fps_time = now;
         }
+    }
+}
+
+void SVAppSimple::printPipelineStats() {
+    // Per frame since the last report; a stage that waits for input is not the bottleneck
+    SVStageMetrics::Sample capture = capture_metrics.take();
+    SVStageMetrics::Sample stitch = stitch_metrics.take();
+    SVStageMetrics::Sample render = render_metrics.take();
+    
+    std::cout << "  Pipeline | capture: cameras " << capture.input_wait_ms << " ms, copy "
+              << capture.work_ms << " ms, blocked " << capture.output_wait_ms << " ms"
+              << " | queue " << capture_queue.takeMeanOccupancy() << "/" << capture_queue.depth()
+              << " | stitch: " << stitch.work_ms << " ms, starved " << stitch.input_wait_ms << " ms"
+              << " | render: " << render.work_ms << " ms, starved " << render.input_wait_ms << " ms"
+              << std::endl;
+    
+    SVFrameScheduler::Sample schedule = frame_scheduler.take();
+    std::cout << "  Schedule | " << PIPELINE_TARGET_FPS << " FPS target: " << schedule.misses
+              << " deadline misses (worst +" << schedule.max_late_ms << " ms)"
+              << ", skipped " << schedule.skipped_stale << " stale, " << schedule.skipped_early << " early"
+              << " | capture to output " << schedule.latency_ms << " ms (jitter "
+              << schedule.latency_jitter_ms << " ms, max " << schedule.latency_max_ms << " ms)"
+              << std::endl;
+}
+
+void SVAppSimple::joinPipeline() {
+    // Release stages blocked on the queue or a frame; each exits once it sees is_running cleared
+    capture_queue.close();
+    frame_scheduler.notifyFrame();
+    
+    if (capture_thread.joinable()) {
+        capture_thread.join();
+    }
+    if (stitch_thread.joinable()) {
+        stitch_thread.join();
+    }
+    if (render_thread.joinable()) {
+        render_thread.join();
+        renderer->attachContext();
+    }
+}
+
+void SVAppSimple::renderLoop() {
+    using Clock = SVStageMetrics::Clock;
+    
+    // Headless has no display to pace against, render each new frame once
+    if (!renderer->attachContext(is_headless ? 0 : 1)) {
+        is_running = false;
+        return;
+    }
+    
+    while (is_running && !renderer->shouldClose()) {
+        auto wait_start = Clock::now();
+        if (is_headless && !frame_mailbox.hasNewFrame()) {
+            frame_scheduler.waitForFrame(std::chrono::milliseconds(PIPELINE_EVENT_TIMEOUT_MS));
+            render_metrics.addInputWait(Clock::now() - wait_start);
+            continue;
+        }
+        
+        // Newest stitched frame, or the previous one again if stitching is behind
+        bool fresh = frame_mailbox.acquire();
+        if (!frame_mailbox.hasFrame()) {
+            frame_scheduler.waitForFrame(std::chrono::milliseconds(PIPELINE_EVENT_TIMEOUT_MS));
+            render_metrics.addInputWait(Clock::now() - wait_start);
+            continue;
+        }
         
-        // Small sleep to prevent CPU spinning
-        std::this_thread::sleep_for(3ms);
+        // Includes the wait for vsync in window mode
+        auto render_start = Clock::now();
+        if (!renderer->render(frame_mailbox.readSlot(), fresh)) {
+            std::cerr << "ERROR: Rendering failed" << std::endl;
+            is_running = false;
+            break;
+        }
+        render_metrics.addWork(Clock::now() - render_start);
+        render_metrics.addFrame();
+        
+        unsigned long rendered = ++rendered_frames;
+        
+        if (is_headless && HEADLESS_SNAPSHOT_EVERY > 0 && rendered % HEADLESS_SNAPSHOT_EVERY == 0) {
+            renderer->saveFrame(HEADLESS_SNAPSHOT_PATH);
+        }
     }
     
-    std::cout << "\nMain loop exited" << std::endl;
+    renderer->detachContext();
+}
+
+void SVAppSimple::streamFrame(const cv::Mat& frame, bool bottom_up) {
+    if (!stream_output->isOpen()) {
+        if (stream_failed) return;
+        stream_failed = !stream_output->init(frame.size(), frame.channels(), STREAM_FPS, STREAM_TARGET);
+        if (stream_failed) {
+            std::cerr << "WARNING: Output stream unavailable, continuing without it" << std::endl;
+            return;
+        }
+    }
+    
+    // Never blocks; drops the frame when the encoder is behind
+    stream_output->push(frame, bottom_up);
+}
+
+void SVAppSimple::publishShared(const cv::cuda::GpuMat& stitched, std::chrono::steady_clock::time_point captured) {
+    if (!shm_publisher->isOpen()) {
+        if (shm_failed) return;
+        shm_failed = !shm_publisher->init(SHM_OUTPUT_NAME, stitched.cols, stitched.rows,
+                                          stitched.channels(), SHM_OUTPUT_SLOTS);
+        if (shm_failed) {
+            std::cerr << "WARNING: Shared memory ring unavailable, continuing without it" << std::endl;
+            return;
+        }
+        
+        // Page-locked slots let the download copy straight into shared memory
+        shm_pinned = cudaHostRegister(shm_publisher->getFrameData(), shm_publisher->getFrameDataSize(),
+                                      cudaHostRegisterDefault) == cudaSuccess;
+        if (!shm_pinned) {
+            std::cerr << "WARNING: Shared memory ring is not page-locked, downloads are staged" << std::endl;
+        }
+    }
+    
+    // Written in place: readers see the slot torn until endWrite()
+    cv::Mat frame(stitched.rows, stitched.cols, stitched.type(),
+                  shm_publisher->beginWrite(), shm_publisher->getStride());
+    stitched.download(frame);
+    
+    // steady_clock is CLOCK_MONOTONIC, the ring's time base
+    shm_publisher->endWrite(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(captured.time_since_epoch()).count()));
 }
 
 void SVAppSimple::stop() {
     is_running = false;
+    joinPipeline();
+    
+    if (stream_output) {
+        stream_output->close();
+    }
+    
+    if (shm_publisher && shm_publisher->isOpen()) {
+        if (shm_pinned) {
+            cudaHostUnregister(shm_publisher->getFrameData());
+            shm_pinned = false;
+        }
+        shm_publisher->close();
+    }
     
     if (camera_source) {
         std::cout << "Stopping camera streams..." << std::endl;
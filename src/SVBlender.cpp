@@ -239,9 +239,10 @@ void SVFeatherBlender::prepare(const std::vector<cv::Point> &corners, const std:
 
 
 // ------------------------------- CUDAMultiBandBlender --------------------------------
-SVMultiBandBlender::SVMultiBandBlender(const int numbands_) : numbands(numbands_)
+SVMultiBandBlender::SVMultiBandBlender(const int numbands_, const int statslevel_) : numbands(numbands_), statslevel(statslevel_)
 {
       CV_Assert(numbands_ >= 1);
+      CV_Assert(statslevel_ <= numbands_);
 
       if (cudaStreamCreate(&_cudaStreamDst) != cudaError::cudaSuccess)
               _cudaStreamDst = NULL;
@@ -302,6 +303,13 @@ void SVMultiBandBlender::prepare_roi(const std::vector<cv::Point> &corners, cons
 	    gpu_ups_.push_back(std::vector<cv::cuda::GpuMat>(numbands + 1));
 	}
 
+	if (statslevel >= 0){
+	    gpu_stats_gauss_.resize(sizes.size());
+	    gpu_stats_masks_.resize(sizes.size());
+	    for (const auto& tlbr : gpu_imgs_corners_)
+	        stats_corners_.emplace_back((tlbr.tl.x - dst_roi_.x) >> statslevel, (tlbr.tl.y - dst_roi_.y) >> statslevel);
+	}
+
 }
 
 void SVMultiBandBlender::prepare_pyr(const cv::Rect& dst_roi)
@@ -354,6 +362,9 @@ void SVMultiBandBlender::prepare(const std::vector<cv::Point> &corners, const st
           cv::cuda::copyMakeBorder(gpu_weight_map_, gpu_weight_pyr_gauss_vec_[i][0], top, bottom, left, right, cv::BORDER_CONSTANT);
           for (auto j = 0; j < numbands; ++j)
               cv::cuda::pyrDown(gpu_weight_pyr_gauss_vec_[i][j], gpu_weight_pyr_gauss_vec_[i][j + 1]);
+
+          if (statslevel >= 0)
+              cv::cuda::compare(gpu_weight_pyr_gauss_vec_[i][statslevel], 0.5, gpu_stats_masks_[i], cv::CMP_GT);
       }
 }
 
@@ -376,6 +387,10 @@ void SVMultiBandBlender::feed(const cv::cuda::GpuMat& _img, const int idx, cv::c
       for(auto i = 0; i < numbands; ++i)
           cv::cuda::pyrDown(gpu_src_pyr_laplace_vec_[idx][i], gpu_src_pyr_laplace_vec_[idx][i + 1], streamObj);
 
+      /* keep the Gaussian level for exposure statistics, it is overwritten by the Laplacian below */
+      if (statslevel >= 0)
+          gpu_src_pyr_laplace_vec_[idx][statslevel].copyTo(gpu_stats_gauss_[idx], streamObj);
+
       for(auto i = 0; i < numbands; ++i){
           cv::cuda::pyrUp(gpu_src_pyr_laplace_vec_[idx][i + 1], gpu_ups_[idx][i], streamObj);
           cv::cuda::subtract(gpu_src_pyr_laplace_vec_[idx][i], gpu_ups_[idx][i], gpu_src_pyr_laplace_vec_[idx][i], cv::noArray(), -1, streamObj);
@@ -405,6 +420,24 @@ void SVMultiBandBlender::feed(const cv::cuda::GpuMat& _img, const int idx, cv::c
 }
 
 
+bool SVMultiBandBlender::getStatsLevel(std::vector<cv::cuda::GpuMat>& imgs, std::vector<cv::cuda::GpuMat>& masks,
+                                       std::vector<cv::Point>& corners) const
+{
+    if (statslevel < 0 || gpu_stats_gauss_.empty())
+        return false;
+
+    for (const auto& img : gpu_stats_gauss_)
+        if (img.empty())
+            return false;
+
+    imgs = gpu_stats_gauss_;
+    masks = gpu_stats_masks_;
+    corners = stats_corners_;
+
+    return true;
+}
+
+
 void SVMultiBandBlender::blend(cv::cuda::GpuMat &dst, cv::cuda::GpuMat &dst_mask, cv::cuda::Stream& streamObj)
 {
     for (auto i = 0; i <= numbands; ++i){
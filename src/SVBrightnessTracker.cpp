@@ -0,0 +1,44 @@
+#include "SVBrightnessTracker.hpp"
+#include <algorithm>
+#include <cmath>
+
+SVBrightnessTracker::SVBrightnessTracker(const size_t cams_num, const float drift_threshold,
+                                         const int min_interval_ms)
+    : min_interval(std::chrono::milliseconds(min_interval_ms)),
+      threshold(drift_threshold), max_drift(0.0f),
+      update_count(0), suppressed_count(0), num_cameras(cams_num) {
+}
+
+bool SVBrightnessTracker::update(const std::vector<double>& lumas, const Clock::time_point& now) {
+    if (lumas.size() != num_cameras) {
+        return false;
+    }
+    
+    // First measurement matches the gains computed at initialization
+    if (reference_lumas.empty()) {
+        reference_lumas = lumas;
+        last_update = now;
+        return false;
+    }
+    
+    max_drift = 0.0f;
+    for (size_t i = 0; i < num_cameras; i++) {
+        double drift = std::fabs(lumas[i] - reference_lumas[i]) / std::max(reference_lumas[i], 1.0);
+        max_drift = std::max(max_drift, static_cast<float>(drift));
+    }
+    
+    if (max_drift < threshold) {
+        return false;
+    }
+    
+    if (now - last_update < min_interval) {
+        suppressed_count++;
+        return false;
+    }
+    
+    reference_lumas = lumas;
+    last_update = now;
+    update_count++;
+    
+    return true;
+}
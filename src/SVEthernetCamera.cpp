@@ -278,23 +278,34 @@ bool EthernetCameraSource::capture(cv::cuda::GpuMat& frame, size_t timeout) {
 // ============================================================================
 
 MultiCameraSource::MultiCameraSource()
-    : _cams({
-          EthernetCameraSource("192.168.45.10", 5020, "192.168.45.3", "Front"),
-          EthernetCameraSource("192.168.45.11", 5021, "192.168.45.3", "Left"),
-          EthernetCameraSource("192.168.45.12", 5022, "192.168.45.3", "Rear"),
-          EthernetCameraSource("192.168.45.13", 5023, "192.168.45.3", "Right")
-          
-        //   EthernetCameraSource("192.168.45.11", 5021, "192.168.45.3", "Right"),   // Index 0 ✅
-        //   EthernetCameraSource("192.168.45.12", 5022, "192.168.45.3", "Front"),  // Index 1 ✅
-        //   EthernetCameraSource("192.168.45.13", 5023, "192.168.45.3", "Left"),   // Index 2 ✅ 
-        //   EthernetCameraSource("192.168.45.10", 5020, "192.168.45.3", "Rear")    // Index 3 ✅ MUST BE LAST!
-
+    : MultiCameraSource(true)
+{
+}
 
-          
-      })
+MultiCameraSource::MultiCameraSource(const bool ethernetCameras)
+    : cudaStreamObj(cv::cuda::Stream::Null())
     , destIP("192.168.45.3")
-    , cudaStreamObj(cv::cuda::Stream::Null())
 {
+    for (int i = 0; i < CAM_NUMS; ++i) {
+        _cudaStream[i] = nullptr;
+    }
+    
+    if (!ethernetCameras) {
+        return;
+    }
+    
+    // Reserved up front: the sources are never copied once constructed
+    _cams.reserve(CAM_NUMS);
+    _cams.emplace_back("192.168.45.10", 5020, "192.168.45.3", "Front");
+    _cams.emplace_back("192.168.45.11", 5021, "192.168.45.3", "Left");
+    _cams.emplace_back("192.168.45.12", 5022, "192.168.45.3", "Rear");
+    _cams.emplace_back("192.168.45.13", 5023, "192.168.45.3", "Right");
+    
+    //   EthernetCameraSource("192.168.45.11", 5021, "192.168.45.3", "Right"),   // Index 0 ✅
+    //   EthernetCameraSource("192.168.45.12", 5022, "192.168.45.3", "Front"),  // Index 1 ✅
+    //   EthernetCameraSource("192.168.45.13", 5023, "192.168.45.3", "Left"),   // Index 2 ✅ 
+    //   EthernetCameraSource("192.168.45.10", 5020, "192.168.45.3", "Rear")    // Index 3 ✅ MUST BE LAST!
+    
     // Initialize CUDA streams
     for (int i = 0; i < CAM_NUMS; ++i) {
         if (cudaStreamCreate(&_cudaStream[i]) != cudaSuccess) {
@@ -317,8 +328,8 @@ int MultiCameraSource::init(const std::string& param_filepath, const cv::Size& c
     _undistort = useUndist;
     
     // Initialize all cameras
-    bool allCamsOk = true;
-    for (size_t i = 0; i < CAM_NUMS; ++i) {
+    bool allCamsOk = !_cams.empty();
+    for (size_t i = 0; i < _cams.size(); ++i) {
         LOG_DEBUG("Initializing camera %zu: %s...", i, _cams[i].getCameraName().c_str());
         bool res = _cams[i].init(frameSize);
         LOG_DEBUG("Camera %zu init %s", i, res ? "OK" : "FAILED");
@@ -330,42 +341,7 @@ int MultiCameraSource::init(const std::string& param_filepath, const cv::Size& c
         return -1;
     }
     
-    // ✅ ONLY load calibration if undistortion is enabled AND path is provided
-    if (_undistort && !param_filepath.empty()) {
-        LOG_DEBUG("Loading calibration files from: %s", param_filepath.c_str());
-        
-        for (size_t i = 0; i < CAM_NUMS; ++i) {
-            if (!camIparams[i].read(param_filepath, i, calibSize, frameSize)) {
-                LOG_ERROR("Failed to read calibration for camera %zu", i);
-                LOG_WARNING("Disabling undistortion due to missing calibration files");
-                _undistort = false;  // ✅ Disable undistortion if calibration fails
-                break;
-            }
-            
-            // Create camera matrix
-            cv::Mat K(3, 3, CV_64FC1);
-            for (size_t k = 0; k < camIparams[i].K.size(); ++k)
-                K.at<double>(k) = camIparams[i].K[k];
-            
-            cv::Mat D(camIparams[i].distortion);
-            
-            // Compute undistortion maps
-            cv::Mat newK = cv::getOptimalNewCameraMatrix(K, D, undistSize, 1, undistSize,
-                                                         &undistFrames[i].roiFrame);
-            Ks[i] = newK;
-            
-            cv::Mat mapX, mapY;
-            cv::initUndistortRectifyMap(K, D, cv::Mat(), newK, undistSize,
-                                       CV_32FC1, mapX, mapY);
-            
-            undistFrames[i].remapX.upload(mapX);
-            undistFrames[i].remapY.upload(mapY);
-            
-            LOG_DEBUG("Generated undistortion maps for camera %zu", i);
-        }
-    } else {
-        LOG_DEBUG("Undistortion disabled - using raw camera frames");
-    }
+    initUndistortion(param_filepath, calibSize, undistSize);
     
     LOG_DEBUG("Multi-camera source initialized successfully");
     return 0;
@@ -416,29 +392,74 @@ bool MultiCameraSource::capture(std::array<Frame, CAM_NUMS>& frames) {
             continue;
         }
         
-        // Apply undistortion if enabled
-        if (_undistort && !undistFrames[i].remapX.empty()) {
-            cv::cuda::remap(rawFrame, undistFrames[i].undistFrame,
-                           undistFrames[i].remapX, undistFrames[i].remapY,
-                           cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar());
-            
-            // Validate ROI before cropping
-            if (undistFrames[i].roiFrame.x >= 0 && 
-                undistFrames[i].roiFrame.y >= 0 &&
-                undistFrames[i].roiFrame.x + undistFrames[i].roiFrame.width <= undistFrames[i].undistFrame.cols &&
-                undistFrames[i].roiFrame.y + undistFrames[i].roiFrame.height <= undistFrames[i].undistFrame.rows) {
-                
-                frames[i].gpuFrame = undistFrames[i].undistFrame(undistFrames[i].roiFrame);
-            } else {
-                LOG_WARNING("Invalid ROI for camera %zu, using full undistorted frame", i);
-                frames[i].gpuFrame = undistFrames[i].undistFrame;
+        undistortFrame(i, rawFrame, frames[i]);
+    }
+    
+    return allCaptured;
+}
+
+void MultiCameraSource::initUndistortion(const std::string& param_filepath, const cv::Size& calibSize,
+                                         const cv::Size& undistSize)
+{
+    // ✅ ONLY load calibration if undistortion is enabled AND path is provided
+    if (_undistort && !param_filepath.empty()) {
+        LOG_DEBUG("Loading calibration files from: %s", param_filepath.c_str());
+        
+        for (size_t i = 0; i < CAM_NUMS; ++i) {
+            if (!camIparams[i].read(param_filepath, i, calibSize, frameSize)) {
+                LOG_ERROR("Failed to read calibration for camera %zu", i);
+                LOG_WARNING("Disabling undistortion due to missing calibration files");
+                _undistort = false;  // ✅ Disable undistortion if calibration fails
+                break;
             }
+            
+            // Create camera matrix
+            cv::Mat K(3, 3, CV_64FC1);
+            for (size_t k = 0; k < camIparams[i].K.size(); ++k)
+                K.at<double>(k) = camIparams[i].K[k];
+            
+            cv::Mat D(camIparams[i].distortion);
+            
+            // Compute undistortion maps
+            cv::Mat newK = cv::getOptimalNewCameraMatrix(K, D, undistSize, 1, undistSize,
+                                                         &undistFrames[i].roiFrame);
+            Ks[i] = newK;
+            
+            cv::Mat mapX, mapY;
+            cv::initUndistortRectifyMap(K, D, cv::Mat(), newK, undistSize,
+                                       CV_32FC1, mapX, mapY);
+            
+            undistFrames[i].remapX.upload(mapX);
+            undistFrames[i].remapY.upload(mapY);
+            
+            LOG_DEBUG("Generated undistortion maps for camera %zu", i);
+        }
+    } else {
+        LOG_DEBUG("Undistortion disabled - using raw camera frames");
+    }
+}
+
+void MultiCameraSource::undistortFrame(size_t idx, cv::cuda::GpuMat& rawFrame, Frame& frame) {
+    // Apply undistortion if enabled
+    if (_undistort && !undistFrames[idx].remapX.empty()) {
+        cv::cuda::remap(rawFrame, undistFrames[idx].undistFrame,
+                       undistFrames[idx].remapX, undistFrames[idx].remapY,
+                       cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar());
+        
+        // Validate ROI before cropping
+        if (undistFrames[idx].roiFrame.x >= 0 && 
+            undistFrames[idx].roiFrame.y >= 0 &&
+            undistFrames[idx].roiFrame.x + undistFrames[idx].roiFrame.width <= undistFrames[idx].undistFrame.cols &&
+            undistFrames[idx].roiFrame.y + undistFrames[idx].roiFrame.height <= undistFrames[idx].undistFrame.rows) {
+            
+            frame.gpuFrame = undistFrames[idx].undistFrame(undistFrames[idx].roiFrame);
         } else {
-            frames[i].gpuFrame = rawFrame;
+            LOG_WARNING("Invalid ROI for camera %zu, using full undistorted frame", idx);
+            frame.gpuFrame = undistFrames[idx].undistFrame;
         }
+    } else {
+        frame.gpuFrame = rawFrame;
     }
-    
-    return allCaptured;
 }
 
 bool MultiCameraSource::setFrameSize(const cv::Size& size) {
@@ -0,0 +1,468 @@
+#include <SVExposureKernels.hpp>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+static constexpr int MAX_CHANNELS = 3;
+static constexpr unsigned char MASK_THRESHOLD = 128;  // same test as kernelgain.cu: mask > 128
+
+
+// ------------------------------- helpers --------------------------------
+namespace {
+
+template <typename T>
+inline int histBin(const T val) { return static_cast<int>(val); }
+
+template <>
+inline int histBin<short>(const short val) { return std::min(std::max(static_cast<int>(val), 0), 255); }
+
+
+template <typename T>
+inline T saturateGain(const float val);
+
+template <>
+inline unsigned char saturateGain<unsigned char>(const float val) {
+    return static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, val)));
+}
+
+template <>
+inline short saturateGain<short>(const float val) {
+    return static_cast<short>(std::min(32767.0f, std::max(-32768.0f, val)));
+}
+
+
+/* masked sums of one row for one or two images (img2 may be null), scalar path */
+template <typename T, typename Acc>
+inline void sumMaskedRowScalar(const T* img1, const T* img2, const unsigned char* mask, const int x0,
+                               const int width, const int channels, Acc* sum1, Acc* sum2, int64_t& count)
+{
+    for (int x = x0; x < width; ++x){
+        if (mask[x] <= MASK_THRESHOLD)
+            continue;
+        for (int c = 0; c < channels; ++c){
+            sum1[c] += img1[x * channels + c];
+            if (img2)
+                sum2[c] += img2[x * channels + c];
+        }
+        ++count;
+    }
+}
+
+
+#if CV_SIMD
+inline void accumulate8u(const cv::v_uint8& v, cv::v_uint32& acc)
+{
+    cv::v_uint16 lo, hi;
+    cv::v_expand(v, lo, hi);
+    cv::v_uint32 a, b;
+    cv::v_expand(lo + hi, a, b);
+    acc += a + b;
+}
+
+inline void accumulate16s(const cv::v_int16& v, cv::v_int32& acc)
+{
+    cv::v_int32 a, b;
+    cv::v_expand(v, a, b);
+    acc += a + b;
+}
+
+inline cv::v_uint8 mulGain8u(const cv::v_uint8& v, const cv::v_float32& g)
+{
+    const cv::v_float32 vmin = cv::vx_setzero_f32();
+    const cv::v_float32 vmax = cv::vx_setall_f32(255.0f);
+    cv::v_uint16 lo, hi;
+    cv::v_expand(v, lo, hi);
+    cv::v_uint32 q0, q1, q2, q3;
+    cv::v_expand(lo, q0, q1);
+    cv::v_expand(hi, q2, q3);
+    auto mul = [&](const cv::v_uint32& q) {
+        cv::v_float32 f = cv::v_cvt_f32(cv::v_reinterpret_as_s32(q)) * g;
+        return cv::v_trunc(cv::v_min(cv::v_max(f, vmin), vmax));
+    };
+    return cv::v_pack_u(cv::v_pack(mul(q0), mul(q1)), cv::v_pack(mul(q2), mul(q3)));
+}
+
+inline cv::v_int16 mulGain16s(const cv::v_int16& v, const cv::v_float32& g)
+{
+    const cv::v_float32 vmin = cv::vx_setall_f32(-32768.0f);
+    const cv::v_float32 vmax = cv::vx_setall_f32(32767.0f);
+    cv::v_int32 lo, hi;
+    cv::v_expand(v, lo, hi);
+    auto mul = [&](const cv::v_int32& q) {
+        cv::v_float32 f = cv::v_cvt_f32(q) * g;
+        return cv::v_trunc(cv::v_min(cv::v_max(f, vmin), vmax));
+    };
+    return cv::v_pack(mul(lo), mul(hi));
+}
+#endif
+
+
+/* masked sums of one row, returns number of pixels handled by the vector path */
+inline int sumMaskedRow(const unsigned char* img1, const unsigned char* img2, const unsigned char* mask,
+                        const int width, const int channels, uint64_t* sum1, uint64_t* sum2, int64_t& count)
+{
+    int x = 0;
+#if CV_SIMD
+    if (channels == 3 || channels == 1){
+        const int step = cv::v_uint8::nlanes;
+        const cv::v_uint8 thr = cv::vx_setall_u8(MASK_THRESHOLD);
+        const cv::v_uint8 one = cv::vx_setall_u8(1);
+        cv::v_uint32 acc1[MAX_CHANNELS], acc2[MAX_CHANNELS], acc_count = cv::vx_setzero_u32();
+        for (int c = 0; c < MAX_CHANNELS; ++c){
+            acc1[c] = cv::vx_setzero_u32();
+            acc2[c] = cv::vx_setzero_u32();
+        }
+
+        for (; x <= width - step; x += step){
+            cv::v_uint8 m = cv::vx_load(mask + x) > thr;
+            if (channels == 3){
+                cv::v_uint8 b, g, r;
+                cv::v_load_deinterleave(img1 + x * 3, b, g, r);
+                accumulate8u(b & m, acc1[0]);
+                accumulate8u(g & m, acc1[1]);
+                accumulate8u(r & m, acc1[2]);
+                if (img2){
+                    cv::v_load_deinterleave(img2 + x * 3, b, g, r);
+                    accumulate8u(b & m, acc2[0]);
+                    accumulate8u(g & m, acc2[1]);
+                    accumulate8u(r & m, acc2[2]);
+                }
+            }
+            else{
+                accumulate8u(cv::vx_load(img1 + x) & m, acc1[0]);
+                if (img2)
+                    accumulate8u(cv::vx_load(img2 + x) & m, acc2[0]);
+            }
+            accumulate8u(m & one, acc_count);
+        }
+
+        for (int c = 0; c < channels; ++c){
+            sum1[c] += cv::v_reduce_sum(acc1[c]);
+            sum2[c] += cv::v_reduce_sum(acc2[c]);
+        }
+        count += cv::v_reduce_sum(acc_count);
+    }
+#endif
+    sumMaskedRowScalar(img1, img2, mask, x, width, channels, sum1, sum2, count);
+    return x;
+}
+
+inline int sumMaskedRow(const short* img1, const short* img2, const unsigned char* mask,
+                        const int width, const int channels, int64_t* sum1, int64_t* sum2, int64_t& count)
+{
+    int x = 0;
+#if CV_SIMD
+    if (channels == 3 || channels == 1){
+        const int step = cv::v_int16::nlanes;
+        const cv::v_uint16 thr = cv::vx_setall_u16(MASK_THRESHOLD);
+        const cv::v_uint16 one = cv::vx_setall_u16(1);
+        cv::v_int32 acc1[MAX_CHANNELS], acc2[MAX_CHANNELS];
+        cv::v_uint32 acc_count = cv::vx_setzero_u32();
+        for (int c = 0; c < MAX_CHANNELS; ++c){
+            acc1[c] = cv::vx_setzero_s32();
+            acc2[c] = cv::vx_setzero_s32();
+        }
+
+        for (; x <= width - step; x += step){
+            cv::v_uint16 m16 = cv::vx_load_expand(mask + x) > thr;
+            cv::v_int16 m = cv::v_reinterpret_as_s16(m16);
+            if (channels == 3){
+                cv::v_int16 b, g, r;
+                cv::v_load_deinterleave(img1 + x * 3, b, g, r);
+                accumulate16s(b & m, acc1[0]);
+                accumulate16s(g & m, acc1[1]);
+                accumulate16s(r & m, acc1[2]);
+                if (img2){
+                    cv::v_load_deinterleave(img2 + x * 3, b, g, r);
+                    accumulate16s(b & m, acc2[0]);
+                    accumulate16s(g & m, acc2[1]);
+                    accumulate16s(r & m, acc2[2]);
+                }
+            }
+            else{
+                accumulate16s(cv::vx_load(img1 + x) & m, acc1[0]);
+                if (img2)
+                    accumulate16s(cv::vx_load(img2 + x) & m, acc2[0]);
+            }
+            cv::v_uint32 c0, c1;
+            cv::v_expand(m16 & one, c0, c1);
+            acc_count += c0 + c1;
+        }
+
+        for (int c = 0; c < channels; ++c){
+            sum1[c] += cv::v_reduce_sum(acc1[c]);
+            sum2[c] += cv::v_reduce_sum(acc2[c]);
+        }
+        count += cv::v_reduce_sum(acc_count);
+    }
+#endif
+    sumMaskedRowScalar(img1, img2, mask, x, width, channels, sum1, sum2, count);
+    return x;
+}
+
+
+/* row band parallel masked sums, writes the kernelgain.cu output layout */
+template <typename T, typename Acc>
+void computeMaskedSums(const T* img1, const T* img2, const unsigned char* mask, float* out,
+                       const int width, const int height, const int channels)
+{
+    CV_Assert(channels >= 1 && channels <= MAX_CHANNELS);
+
+    Acc total1[MAX_CHANNELS]{}, total2[MAX_CHANNELS]{};
+    int64_t total_count = 0;
+    std::mutex merge_mutex;
+
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& rows) {
+        Acc sum1[MAX_CHANNELS]{}, sum2[MAX_CHANNELS]{};
+        int64_t count = 0;
+        for (int y = rows.start; y < rows.end; ++y){
+            const size_t offset = static_cast<size_t>(y) * width;
+            sumMaskedRow(img1 + offset * channels, img2 ? img2 + offset * channels : nullptr,
+                         mask + offset, width, channels, sum1, sum2, count);
+        }
+
+        std::lock_guard<std::mutex> lock(merge_mutex);
+        for (int c = 0; c < channels; ++c){
+            total1[c] += sum1[c];
+            total2[c] += sum2[c];
+        }
+        total_count += count;
+    });
+
+    const int count_int = static_cast<int>(total_count);
+    if (img2){
+        for (int c = 0; c < channels; ++c){
+            out[c * 2] = static_cast<float>(total1[c]);
+            out[c * 2 + 1] = static_cast<float>(total2[c]);
+        }
+        std::memcpy(&out[channels * 2], &count_int, sizeof(int));
+    }
+    else{
+        for (int c = 0; c < channels; ++c)
+            out[c] = static_cast<float>(total1[c]);
+        std::memcpy(&out[channels], &count_int, sizeof(int));
+    }
+}
+
+
+/* bins of one row as one 8-bit plane per channel (bins + c * width), returns pixels done by the vector path */
+inline int histBinsRow(const unsigned char* row, unsigned char* bins, const int width, const int channels)
+{
+    int x = 0;
+#if CV_SIMD
+    const int step = cv::v_uint8::nlanes;
+    if (channels == 3){
+        for (; x <= width - step; x += step){
+            cv::v_uint8 b, g, r;
+            cv::v_load_deinterleave(row + x * 3, b, g, r);
+            cv::v_store(bins + x, b);
+            cv::v_store(bins + width + x, g);
+            cv::v_store(bins + 2 * width + x, r);
+        }
+    }
+    else if (channels == 1){
+        for (; x <= width - step; x += step)
+            cv::v_store(bins + x, cv::vx_load(row + x));
+    }
+#endif
+    return x;
+}
+
+/* 16S: saturating pack to 8U is the clamp to [0, 255] of kernelgain.cu */
+inline int histBinsRow(const short* row, unsigned char* bins, const int width, const int channels)
+{
+    int x = 0;
+#if CV_SIMD
+    const int step = cv::v_int16::nlanes;
+    if (channels == 3){
+        for (; x <= width - step; x += step){
+            cv::v_int16 b, g, r;
+            cv::v_load_deinterleave(row + x * 3, b, g, r);
+            cv::v_pack_u_store(bins + x, b);
+            cv::v_pack_u_store(bins + width + x, g);
+            cv::v_pack_u_store(bins + 2 * width + x, r);
+        }
+    }
+    else if (channels == 1){
+        for (; x <= width - step; x += step)
+            cv::v_pack_u_store(bins + x, cv::vx_load(row + x));
+    }
+#endif
+    return x;
+}
+
+
+/* bins are computed with intrinsics (deinterleave, 16S clamp); the increments have no vector form
+   and go to 4 sub-histograms, one per lane of x, so repeated bins do not serialize on one counter */
+template <typename T>
+void computeHistogram(const T* image, unsigned int* histogram, const int width, const int height, const int channels)
+{
+    CV_Assert(channels >= 1 && channels <= MAX_CHANNELS);
+
+    constexpr int SUB_HISTS = 4;
+    std::memset(histogram, 0, 256 * channels * sizeof(unsigned int));
+    std::mutex merge_mutex;
+
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& rows) {
+        unsigned int hist[SUB_HISTS][256 * MAX_CHANNELS]{};
+        std::vector<unsigned char> bins(static_cast<size_t>(width) * channels);
+
+        for (int y = rows.start; y < rows.end; ++y){
+            const T* row = image + static_cast<size_t>(y) * width * channels;
+            for (int x = histBinsRow(row, bins.data(), width, channels); x < width; ++x)
+                for (int c = 0; c < channels; ++c)
+                    bins[c * width + x] = static_cast<unsigned char>(histBin(row[x * channels + c]));
+
+            for (int c = 0; c < channels; ++c){
+                const unsigned char* plane = bins.data() + c * width;
+                unsigned int* h0 = hist[0] + c * 256;
+                unsigned int* h1 = hist[1] + c * 256;
+                unsigned int* h2 = hist[2] + c * 256;
+                unsigned int* h3 = hist[3] + c * 256;
+                int x = 0;
+                for (; x <= width - SUB_HISTS; x += SUB_HISTS){
+                    ++h0[plane[x]];
+                    ++h1[plane[x + 1]];
+                    ++h2[plane[x + 2]];
+                    ++h3[plane[x + 3]];
+                }
+                for (; x < width; ++x)
+                    ++h0[plane[x]];
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(merge_mutex);
+        for (int i = 0; i < 256 * channels; ++i)
+            histogram[i] += hist[0][i] + hist[1][i] + hist[2][i] + hist[3][i];
+    });
+}
+
+
+inline int applyGainRow(const unsigned char* src, unsigned char* dst, const float* gains, const int width, const int channels)
+{
+    int x = 0;
+#if CV_SIMD
+    const int step = cv::v_uint8::nlanes;
+    if (channels == 3){
+        const cv::v_float32 g0 = cv::vx_setall_f32(gains[0]), g1 = cv::vx_setall_f32(gains[1]), g2 = cv::vx_setall_f32(gains[2]);
+        for (; x <= width - step; x += step){
+            cv::v_uint8 b, g, r;
+            cv::v_load_deinterleave(src + x * 3, b, g, r);
+            cv::v_store_interleave(dst + x * 3, mulGain8u(b, g0), mulGain8u(g, g1), mulGain8u(r, g2));
+        }
+    }
+    else if (channels == 1){
+        const cv::v_float32 g0 = cv::vx_setall_f32(gains[0]);
+        for (; x <= width - step; x += step)
+            cv::v_store(dst + x, mulGain8u(cv::vx_load(src + x), g0));
+    }
+#endif
+    return x;
+}
+
+inline int applyGainRow(const short* src, short* dst, const float* gains, const int width, const int channels)
+{
+    int x = 0;
+#if CV_SIMD
+    const int step = cv::v_int16::nlanes;
+    if (channels == 3){
+        const cv::v_float32 g0 = cv::vx_setall_f32(gains[0]), g1 = cv::vx_setall_f32(gains[1]), g2 = cv::vx_setall_f32(gains[2]);
+        for (; x <= width - step; x += step){
+            cv::v_int16 b, g, r;
+            cv::v_load_deinterleave(src + x * 3, b, g, r);
+            cv::v_store_interleave(dst + x * 3, mulGain16s(b, g0), mulGain16s(g, g1), mulGain16s(r, g2));
+        }
+    }
+    else if (channels == 1){
+        const cv::v_float32 g0 = cv::vx_setall_f32(gains[0]);
+        for (; x <= width - step; x += step)
+            cv::v_store(dst + x, mulGain16s(cv::vx_load(src + x), g0));
+    }
+#endif
+    return x;
+}
+
+
+template <typename T>
+void applyGain(const T* src, T* dst, const float* gains, const int width, const int height, const int channels)
+{
+    CV_Assert(channels >= 1 && channels <= MAX_CHANNELS);
+
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y){
+            const size_t offset = static_cast<size_t>(y) * width * channels;
+            const T* src_row = src + offset;
+            T* dst_row = dst + offset;
+            for (int x = applyGainRow(src_row, dst_row, gains, width, channels); x < width; ++x)
+                for (int c = 0; c < channels; ++c)
+                    dst_row[x * channels + c] = saturateGain<T>(static_cast<float>(src_row[x * channels + c]) * gains[c]);
+        }
+    });
+}
+
+} // namespace
+
+
+// ------------------------------- entry points --------------------------------
+extern "C"
+void cpuComputeHistogram(const unsigned char* image, unsigned int* histogram,
+                         int width, int height, int channels)
+{
+    computeHistogram(image, histogram, width, height, channels);
+}
+
+extern "C"
+void cpuComputeHistogram16s(const short* image, unsigned int* histogram,
+                            int width, int height, int channels)
+{
+    computeHistogram(image, histogram, width, height, channels);
+}
+
+extern "C"
+void cpuComputeMean(const unsigned char* image, float* mean, const unsigned char* mask,
+                    int width, int height, int channels)
+{
+    computeMaskedSums<unsigned char, uint64_t>(image, nullptr, mask, mean, width, height, channels);
+}
+
+extern "C"
+void cpuComputeMean16s(const short* image, float* mean, const unsigned char* mask,
+                       int width, int height, int channels)
+{
+    computeMaskedSums<short, int64_t>(image, nullptr, mask, mean, width, height, channels);
+}
+
+extern "C"
+void cpuApplyGain(const unsigned char* src, unsigned char* dst, const float* gains,
+                  int width, int height, int channels)
+{
+    applyGain(src, dst, gains, width, height, channels);
+}
+
+extern "C"
+void cpuApplyGain16s(const short* src, short* dst, const float* gains,
+                     int width, int height, int channels)
+{
+    applyGain(src, dst, gains, width, height, channels);
+}
+
+extern "C"
+void cpuComputeOverlapGain(const unsigned char* img1, const unsigned char* img2, const unsigned char* mask,
+                           float* gain, int width, int height, int channels)
+{
+    computeMaskedSums<unsigned char, uint64_t>(img1, img2, mask, gain, width, height, channels);
+}
+
+extern "C"
+void cpuComputeOverlapGain16s(const short* img1, const short* img2, const unsigned char* mask,
+                              float* gain, int width, int height, int channels)
+{
+    computeMaskedSums<short, int64_t>(img1, img2, mask, gain, width, height, channels);
+}
@@ -0,0 +1,83 @@
+#include "SVFrameScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+
+SVFrameScheduler::SVFrameScheduler(const float target_fps)
+    : period(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / std::max(target_fps, 1.0f)))),
+      anchored(false), latency_sum(0.0), latency_sq_sum(0.0),
+      misses_total(0), skipped_total(0), frame_generation(0), seen_generation(0) {
+}
+
+bool SVFrameScheduler::admit(const Clock::time_point& now) {
+    if (!anchored) {
+        next_slot = now;
+        anchored = true;
+    }
+
+    // Arrival jitter up to half a period still belongs to the next slot
+    if (now + period / 2 < next_slot) {
+        interval.skipped_early++;
+        return false;
+    }
+
+    // More than a slot late (source stalled): restart the schedule here, no catch-up burst
+    Clock::time_point slot_start = next_slot;
+    if (now > next_slot + period) {
+        slot_start = now;
+    }
+
+    deadline = slot_start + period;
+    next_slot = deadline;
+    return true;
+}
+
+bool SVFrameScheduler::complete(const Clock::time_point& captured, const Clock::time_point& now) {
+    const double latency = std::chrono::duration<double, std::milli>(now - captured).count();
+    interval.frames++;
+    latency_sum += latency;
+    latency_sq_sum += latency * latency;
+    interval.latency_max_ms = std::max(interval.latency_max_ms, static_cast<float>(latency));
+
+    if (now <= deadline) {
+        return true;
+    }
+
+    interval.misses++;
+    misses_total++;
+    interval.max_late_ms = std::max(interval.max_late_ms,
+                                    std::chrono::duration<float, std::milli>(now - deadline).count());
+    return false;
+}
+
+SVFrameScheduler::Sample SVFrameScheduler::take() {
+    Sample sample = interval;
+    if (sample.frames > 0) {
+        const double mean = latency_sum / sample.frames;
+        sample.latency_ms = static_cast<float>(mean);
+        sample.latency_jitter_ms = static_cast<float>(
+            std::sqrt(std::max(latency_sq_sum / sample.frames - mean * mean, 0.0)));
+    }
+
+    interval = Sample();
+    latency_sum = 0.0;
+    latency_sq_sum = 0.0;
+    return sample;
+}
+
+void SVFrameScheduler::notifyFrame() {
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        frame_generation++;
+    }
+    frame_cond.notify_all();
+}
+
+bool SVFrameScheduler::waitForFrame(const Clock::duration& timeout) {
+    std::unique_lock<std::mutex> lock(frame_mutex);
+    const bool woken = frame_cond.wait_for(lock, timeout, [this] {
+        return frame_generation != seen_generation;
+    });
+    seen_generation = frame_generation;
+    return woken;
+}
@@ -18,6 +18,7 @@ SVGainCompensator::SVGainCompensator(const size_t imgs_num_, const int nr_feeds)
     compens = cv::detail::ExposureCompensator::createDefault(cv::detail::ExposureCompensator::GAIN);
     cv::detail::GainCompensator* gain_comp = dynamic_cast<cv::detail::GainCompensator*>(compens.get());
     gain_comp->setNrFeeds(nr_feeds);
+    gains = cv::Mat_<double>::ones(imgs_num, 1);
 }
 
 
@@ -61,6 +62,18 @@ void SVGainCompensator::recompute(const std::vector<cv::cuda::GpuMat>& images,
     computeGains(corners, images, masks);
 }
 
+void SVGainCompensator::update(const std::vector<cv::cuda::GpuMat>& images,
+                                const std::vector<cv::Point>& corners,
+                                const std::vector<cv::cuda::GpuMat>& masks)
+{
+    cv::Mat_<double> prev_gains = gains.clone();
+
+    computeGains(corners, images, masks);
+
+    for (auto i = 0; i < gains.rows; ++i)
+        gains(i, 0) *= prev_gains(i, 0);
+}
+
 bool SVGainCompensator::apply_compensator(const int idx, cv::cuda::GpuMat& warp_img, cv::cuda::Stream& streamObj)
 {
    if (idx > imgs_num || imgs_num <= 0)
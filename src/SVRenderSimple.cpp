@@ -1,29 +1,88 @@
 #include "SVRenderSimple.hpp"
+#include "BowlMeshCache.hpp"
 #include <GL/gl.h>
 #include <GL/glext.h>  // For glMapBufferRange
 #include <GLFW/glfw3.h>
+#include <EGL/eglext.h>
 #include <cuda_gl_interop.h>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
-SVRenderSimple::SVRenderSimple(int width, int height)
+namespace {
+
+// std140 layout of the "Camera" uniform block
+struct CameraBlock {
+    glm::mat4 view[RENDER_MAX_VIEWS];
+    glm::mat4 projection[RENDER_MAX_VIEWS];
+    glm::vec4 viewport[RENDER_MAX_VIEWS];   // NDC scale (xy) and offset (zw) of the view's tile
+};
+
+} // namespace
+
+SVRenderSimple::SVRenderSimple(int width, int height, bool headless_)
     : screen_width(width), screen_height(height), 
       window(nullptr), 
+      headless(headless_),
+      egl_display(EGL_NO_DISPLAY), egl_context(EGL_NO_CONTEXT), egl_surface(EGL_NO_SURFACE),
+      fbo_id(0), fbo_color_rb(0), fbo_depth_rb(0), last_render_ms(0.0f), last_upload_ms(0.0f),
+      last_bowl_lod(0), last_bowl_vertices(0), camera_ubo(0), view_count(1), camera_tiles(false), tile_vao(0),
       bowl_geometry(0.4f, 0.55f, 0.4f, 0.4f, 0.2f),  // Initialize Bowl with parameters
-      texture_id(0), pbo_id(0), is_init(false), bowl_index_count(0) {
+      bowl_floor_y(0.0f),
+      direct_projection(false), camera_texture_id(0),
+      texture_id(0), pbo_size(0), pbo_index(0), pbo_persistent(false), upload_stalls(0),
+      readback_head(0), readback_pending(0), readback_counter(0), readback_drops(0), last_readback_ms(0.0f),
+      is_init(false) {
+    
+    for (int i = 0; i < RENDER_PBO_COUNT; i++) {
+        pbo_ids[i] = 0;
+        pbo_ptrs[i] = nullptr;
+        pbo_fences[i] = nullptr;
+    }
+    for (int i = 0; i < RENDER_READBACK_PBO_COUNT; i++) {
+        readback_pbos[i] = 0;
+        readback_fences[i] = nullptr;
+        readback_numbers[i] = 0;
+    }
     
     aspect_ratio = static_cast<float>(width) / static_cast<float>(height);
 }
 
 SVRenderSimple::~SVRenderSimple() {
     if (texture_id) glDeleteTextures(1, &texture_id);
-    if (pbo_id) glDeleteBuffers(1, &pbo_id);
-    if (bowl_VAO) glDeleteVertexArrays(1, &bowl_VAO);
-    if (bowl_VBO) glDeleteBuffers(1, &bowl_VBO);
-    if (bowl_EBO) glDeleteBuffers(1, &bowl_EBO);
+    for (int i = 0; i < RENDER_PBO_COUNT; i++) {
+        if (pbo_fences[i]) glDeleteSync(pbo_fences[i]);
+        if (pbo_ptrs[i]) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ids[i]);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        if (pbo_ids[i]) glDeleteBuffers(1, &pbo_ids[i]);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    releaseReadback();
+    for (auto& lod : bowl_lods) {
+        if (lod.VAO) glDeleteVertexArrays(1, &lod.VAO);
+        if (lod.VBO) glDeleteBuffers(1, &lod.VBO);
+        if (lod.EBO) glDeleteBuffers(1, &lod.EBO);
+        if (lod.proj_VBO) glDeleteBuffers(1, &lod.proj_VBO);
+    }
+    if (camera_texture_id) glDeleteTextures(1, &camera_texture_id);
+    if (camera_ubo) glDeleteBuffers(1, &camera_ubo);
+    if (tile_vao) glDeleteVertexArrays(1, &tile_vao);
+    if (fbo_id) glDeleteFramebuffers(1, &fbo_id);
+    if (fbo_color_rb) glDeleteRenderbuffers(1, &fbo_color_rb);
+    if (fbo_depth_rb) glDeleteRenderbuffers(1, &fbo_depth_rb);
     if (window) {
         glfwDestroyWindow(window);
         glfwTerminate();
     }
+    releaseHeadless();
 }
 
 bool SVRenderSimple::init(const std::string& car_model_path,
@@ -32,8 +91,57 @@ bool SVRenderSimple::init(const std::string& car_model_path,
                           const std::string& car_vert_shader,
                           const std::string& car_frag_shader) {
     
-    std::cout << "Initializing renderer..." << std::endl;
+    std::cout << "Initializing renderer" << (headless ? " (headless)" : "") << "..." << std::endl;
+    
+    if (headless ? !initHeadless() : !initWindow()) {
+        return false;
+    }
+    
+    // OpenGL context is ready (native GL on Jetson)
+    std::cout << "OpenGL context created: " << glGetString(GL_RENDERER) << std::endl;
+    
+    glEnable(GL_DEPTH_TEST);
+    glViewport(0, 0, screen_width, screen_height);
+    
+    std::cout << "OpenGL initialized" << std::endl;
+    
+    // View/projection buffer shared by the bowl and car programs
+    setupCameraBuffer();
+    
+    // Setup bowl
+    setupBowl();
     
+    // Load bowl shaders
+    if (!bowl_shader.loadFromFile(bowl_vert_shader, bowl_frag_shader, shaderDefines(),
+                                  cameraPreludePath(bowl_vert_shader))) {
+        std::cerr << "Failed to load bowl shaders" << std::endl;
+        return false;
+    }
+    
+    bindCameraBlock(bowl_shader);
+    bowl_shader.useProgramm();
+    bowl_shader.setInt("texture1", 0);
+    uniforms.bowl_model = bowl_shader.getUniformLocation("model");
+    uniforms.bowl_shape = bowl_shader.getUniformLocation("bowlShape");
+    uniforms.bowl_extent = bowl_shader.getUniformLocation("bowlExtent");
+    uniforms.bowl_grid = bowl_shader.getUniformLocation("bowlGrid");
+    
+    std::cout << "Bowl shaders loaded" << std::endl;
+    
+    // Setup car model
+    setupCarModel(car_model_path, car_vert_shader, car_frag_shader);
+    
+    // Create texture and PBO ring
+    setupTextureUpload();
+    
+    std::cout << "Texture and PBO ring created (" << RENDER_PBO_COUNT << " buffers, "
+              << (pbo_persistent ? "persistent mapping" : "unsynchronized mapping") << ")" << std::endl;
+    
+    is_init = true;
+    return true;
+}
+
+bool SVRenderSimple::initWindow() {
     // Initialize GLFW
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -55,50 +163,127 @@ bool SVRenderSimple::init(const std::string& car_model_path,
     
     glfwMakeContextCurrent(window);
     
-    // OpenGL context is ready (native GL on Jetson)
-    std::cout << "OpenGL context created" << std::endl;
+    return true;
+}
+
+bool SVRenderSimple::initHeadless() {
+    // Prefer the Mesa surfaceless platform (no X/Wayland, works with llvmpipe),
+    // fall back to the default display (e.g. NVIDIA EGL device)
+    const char* client_ext = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (client_ext && std::strstr(client_ext, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            egl_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if (egl_display == EGL_NO_DISPLAY) {
+        egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
     
-    glEnable(GL_DEPTH_TEST);
-    glViewport(0, 0, screen_width, screen_height);
+    EGLint major = 0, minor = 0;
+    if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor)) {
+        std::cerr << "Failed to initialize EGL display" << std::endl;
+        egl_display = EGL_NO_DISPLAY;
+        return false;
+    }
     
-    std::cout << "OpenGL initialized" << std::endl;
+    std::cout << "EGL " << major << "." << minor << " ("
+              << eglQueryString(egl_display, EGL_VENDOR) << ")" << std::endl;
     
-    // Setup bowl
-    setupBowl();
+    const EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
     
-    // Load bowl shaders
-    if (!bowl_shader.loadFromFile(bowl_vert_shader, bowl_frag_shader)) {
-        std::cerr << "Failed to load bowl shaders" << std::endl;
+    EGLConfig config;
+    EGLint num_configs = 0;
+    if (!eglChooseConfig(egl_display, config_attribs, &config, 1, &num_configs) || num_configs < 1) {
+        std::cerr << "No suitable EGL config for offscreen rendering" << std::endl;
+        releaseHeadless();
         return false;
     }
     
-    std::cout << "Bowl shaders loaded" << std::endl;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "Failed to bind OpenGL API" << std::endl;
+        releaseHeadless();
+        return false;
+    }
     
-    // Setup car model
-    setupCarModel(car_model_path, car_vert_shader, car_frag_shader);
+    // Shaders are GLSL 330 core
+    const EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
     
-    // Create texture
-    glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    egl_context = eglCreateContext(egl_display, config, EGL_NO_CONTEXT, context_attribs);
+    if (egl_context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create EGL context (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        releaseHeadless();
+        return false;
+    }
     
-    // Create PBO for fast texture upload
-    glGenBuffers(1, &pbo_id);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_id);
-    glBufferData(GL_PIXEL_UNPACK_BUFFER, 
-                 OUTPUT_WIDTH * OUTPUT_HEIGHT * 3, 
-                 nullptr, GL_STREAM_DRAW);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    // Rendering goes to the FBO, the pbuffer only has to make the context current
+    const EGLint pbuffer_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    egl_surface = eglCreatePbufferSurface(egl_display, config, pbuffer_attribs);
+    if (egl_surface == EGL_NO_SURFACE) {
+        std::cerr << "Failed to create EGL pbuffer surface (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        releaseHeadless();
+        return false;
+    }
     
-    std::cout << "Texture and PBO created" << std::endl;
+    if (!eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context)) {
+        std::cerr << "Failed to make EGL context current (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        releaseHeadless();
+        return false;
+    }
+    
+    // Offscreen framebuffer
+    glGenRenderbuffers(1, &fbo_color_rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, fbo_color_rb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, screen_width, screen_height);
+    
+    glGenRenderbuffers(1, &fbo_depth_rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, fbo_depth_rb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, screen_width, screen_height);
+    
+    glGenFramebuffers(1, &fbo_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo_id);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, fbo_color_rb);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, fbo_depth_rb);
+    
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer incomplete" << std::endl;
+        return false;
+    }
+    
+    std::cout << "Offscreen framebuffer created: " << screen_width << "x" << screen_height << std::endl;
     
-    is_init = true;
     return true;
 }
 
+void SVRenderSimple::releaseHeadless() {
+    if (egl_display == EGL_NO_DISPLAY) {
+        return;
+    }
+    
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (egl_context != EGL_NO_CONTEXT) eglDestroyContext(egl_display, egl_context);
+    if (egl_surface != EGL_NO_SURFACE) eglDestroySurface(egl_display, egl_surface);
+    eglTerminate(egl_display);
+    
+    egl_context = EGL_NO_CONTEXT;
+    egl_surface = EGL_NO_SURFACE;
+    egl_display = EGL_NO_DISPLAY;
+}
+
 void SVRenderSimple::setupBowl() {
     // Bowl configuration
     bowl_config.disk_radius = 0.4f;
@@ -111,31 +296,156 @@ void SVRenderSimple::setupBowl() {
     bowl_config.y_start = 1.0f;
     bowl_config.transformation = glm::mat4(1.0f);
     
-    // Generate bowl geometry using the correct method
-    if (!bowl_geometry.generate_mesh_uv_hole(bowl_config.vertices_num, 
-                                              bowl_config.hole_radius, 
-                                              bowl_vertices, 
-                                              bowl_indices)) {
-        std::cerr << "Failed to generate bowl mesh" << std::endl;
+    // Initial shape reproduces the generated mesh
+    bowl_shape.a = bowl_config.a;
+    bowl_shape.b = bowl_config.b;
+    bowl_shape.c = bowl_config.c;
+    bowl_shape.disk_radius = bowl_config.disk_radius;
+    bowl_shape.outer_radius = bowl_config.parab_radius;
+    bowl_floor_y = bowl_config.c * (bowl_config.disk_radius / bowl_config.a) * (bowl_config.disk_radius / bowl_config.a);
+    
+    // Level-of-detail meshes, dense near the car and the disk/paraboloid transition
+    const std::vector<uint32_t> lod_rings = BOWL_LOD_RINGS;
+    const std::vector<uint32_t> lod_segments = BOWL_LOD_SEGMENTS;
+    const uint32_t band_columns = BOWL_VERTEX_CACHE_SIZE / 2 - 1;
+    
+    // Restart index is context state (GL 3.1, not in the GLES headers): set once here,
+    // restart itself is enabled only around the bowl draw
+    auto primitiveRestartIndex = reinterpret_cast<PFNGLPRIMITIVERESTARTINDEXPROC>(
+        getProcAddress("glPrimitiveRestartIndex"));
+    if (primitiveRestartIndex) {
+        primitiveRestartIndex(Bowl::strip_restart);
+    } else {
+        std::cerr << "glPrimitiveRestartIndex not available, bowl strips will not restart" << std::endl;
+    }
+    
+    auto setup_start = std::chrono::steady_clock::now();
+    
+    // Fast path: upload straight from the memory-mapped cache file
+    BowlMeshCache cache;
+    if (cache.load(BOWL_CACHE_PATH, bowl_config, lod_rings, lod_segments, band_columns)) {
+        bowl_lods.resize(cache.getLodCount());
+        
+        for (size_t i = 0; i < cache.getLodCount(); i++) {
+            const BowlMeshCache::LodView& view = cache.getLod(i);
+            BowlLod& lod = bowl_lods[i];
+            
+            lod.max_edge = view.max_edge;
+            lod.acmr = view.acmr;
+            uploadBowlLod(lod, view.vertices, view.vertex_floats, view.indices, view.index_count,
+                          view.chunks, view.chunk_count);
+            
+            if (RENDER_DIRECT_PROJECTION) {
+                lod.vertices.assign(view.vertices, view.vertices + view.vertex_floats);
+            }
+        }
+        
+        cache.release();
+        
+        float setup_ms = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - setup_start).count();
+        std::cout << "Bowl meshes loaded from " << BOWL_CACHE_PATH << ": " << bowl_lods.size()
+                  << " LODs (" << setup_ms << " ms)" << std::endl;
         return;
     }
     
-    bowl_index_count = bowl_indices.size();
+    std::vector<BowlMeshLod> meshes(BOWL_LOD_COUNT);
+    bowl_lods.resize(BOWL_LOD_COUNT);
+    
+    for (int i = 0; i < BOWL_LOD_COUNT; i++) {
+        BowlMeshLod& mesh = meshes[i];
+        BowlLod& lod = bowl_lods[i];
+        
+        auto gen_start = std::chrono::steady_clock::now();
+        if (!bowl_geometry.generate_mesh_lod(lod_rings[i], lod_segments[i],
+                                             bowl_config.hole_radius, band_columns,
+                                             mesh.vertices, mesh.indices, mesh.chunks)) {
+            std::cerr << "Failed to generate bowl mesh (LOD " << i << ")" << std::endl;
+            bowl_lods.resize(i);
+            meshes.resize(i);
+            break;
+        }
+        
+        float gen_ms = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - gen_start).count();
+        
+        mesh.rings = lod_rings[i];
+        mesh.segments = lod_segments[i];
+        mesh.max_edge = bowl_geometry.lod_max_edge(lod_rings[i], lod_segments[i], bowl_config.hole_radius);
+        mesh.acmr = Bowl::strip_acmr(mesh.indices, mesh.chunks, BOWL_VERTEX_CACHE_SIZE);
+        
+        lod.max_edge = mesh.max_edge;
+        lod.acmr = mesh.acmr;
+        uploadBowlLod(lod, mesh.vertices.data(), mesh.vertices.size(),
+                      mesh.indices.data(), mesh.indices.size(),
+                      mesh.chunks.data(), mesh.chunks.size());
+        
+        if (RENDER_DIRECT_PROJECTION) {
+            lod.vertices = mesh.vertices;
+        }
+        
+        std::cout << "Bowl LOD " << i << " created: " << lod_rings[i] << "x" << lod_segments[i]
+                  << ", " << lod.vertex_count << " vertices, " << lod.index_count << " indices in "
+                  << lod.chunks.size() << " chunk(s), ACMR " << lod.acmr << " (" << gen_ms << " ms)" << std::endl;
+    }
+    
+    // Only a complete set is cached, a failed LOD is retried on the next start
+    if (meshes.size() == static_cast<size_t>(BOWL_LOD_COUNT)) {
+        if (BowlMeshCache::save(BOWL_CACHE_PATH, bowl_config, band_columns, meshes)) {
+            std::cout << "Bowl meshes cached to " << BOWL_CACHE_PATH << std::endl;
+        }
+    }
+}
+
+void SVRenderSimple::uploadBowlLod(BowlLod& lod, const float* vertices, size_t vertex_floats,
+                                   const uint16_t* indices, size_t index_count,
+                                   const BowlIndexChunk* chunks, size_t chunk_count) {
+    lod.vertex_count = vertex_floats / BOWL_VERTEX_STRIDE;
+    lod.index_count = index_count;
+    lod.chunks.assign(chunks, chunks + chunk_count);
     
     // Create VAO, VBO, EBO
-    glGenVertexArrays(1, &bowl_VAO);
-    glGenBuffers(1, &bowl_VBO);
-    glGenBuffers(1, &bowl_EBO);
+    glGenVertexArrays(1, &lod.VAO);
+    glGenBuffers(1, &lod.VBO);
+    glGenBuffers(1, &lod.EBO);
+    
+    glBindVertexArray(lod.VAO);
     
-    glBindVertexArray(bowl_VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(uint16_t), indices, GL_STATIC_DRAW);
     
-    glBindBuffer(GL_ARRAY_BUFFER, bowl_VBO);
-    glBufferData(GL_ARRAY_BUFFER, bowl_vertices.size() * sizeof(float),
-                 bowl_vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, lod.VBO);
     
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bowl_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, bowl_indices.size() * sizeof(unsigned int),
-                 bowl_indices.data(), GL_STATIC_DRAW);
+    if (RENDER_COMPACT_VERTICES) {
+        lod.position_dequant = computePositionDequant(vertices, lod.vertex_count, BOWL_VERTEX_STRIDE);
+        const PositionDequant& dq = lod.position_dequant;
+        
+        std::vector<BowlPackedVertex> packed(lod.vertex_count);
+        for (size_t i = 0; i < lod.vertex_count; i++) {
+            const float* v = vertices + i * BOWL_VERTEX_STRIDE;
+            BowlPackedVertex& p = packed[i];
+            for (int k = 0; k < 3; k++) {
+                p.position[k] = packPosition(v[k], dq.scale[k], dq.offset[k]);
+            }
+            p.position[3] = 0;
+            p.texcoords[0] = packUnorm16(v[BOWL_UV_OFFSET] / Bowl::uv_scale);
+            p.texcoords[1] = packUnorm16(v[BOWL_UV_OFFSET + 1] / Bowl::uv_scale);
+        }
+        
+        glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(BowlPackedVertex), packed.data(), GL_STATIC_DRAW);
+        
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(BowlPackedVertex),
+                              (void*)offsetof(BowlPackedVertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(BowlPackedVertex),
+                              (void*)offsetof(BowlPackedVertex, texcoords));
+        glEnableVertexAttribArray(1);
+        
+        glBindVertexArray(0);
+        return;
+    }
+    
+    glBufferData(GL_ARRAY_BUFFER, vertex_floats * sizeof(float), vertices, GL_STATIC_DRAW);
     
     // Position attribute (x, y, z)
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -147,24 +457,46 @@ void SVRenderSimple::setupBowl() {
     glEnableVertexAttribArray(1);
     
     glBindVertexArray(0);
+}
+
+int SVRenderSimple::selectBowlLod(const glm::mat4& bowl_model) const {
+    if (bowl_lods.empty()) return 0;
+    
+    // Distance from the camera to the nearest part of the bowl rim
+    const float model_scale = glm::length(glm::vec3(bowl_model[0]));
+    const float bowl_radius = bowl_config.parab_radius * model_scale;
+    const float center_distance = glm::length(camera.position - glm::vec3(bowl_model[3]));
+    const float distance = std::max(std::abs(center_distance - bowl_radius), 0.1f);
+    
+    const float pixels_per_radian = screen_height / (2.0f * std::tan(glm::radians(camera.zoom) * 0.5f));
     
-    std::cout << "Bowl geometry created: " << bowl_index_count << " indices" << std::endl;
+    for (int i = static_cast<int>(bowl_lods.size()) - 1; i > 0; i--) {
+        const float edge_pixels = bowl_lods[i].max_edge * model_scale / distance * pixels_per_radian;
+        if (edge_pixels <= BOWL_LOD_MAX_EDGE_PIXELS) {
+            return i;
+        }
+    }
+    
+    return 0;
 }
 
 void SVRenderSimple::setupCarModel(const std::string& model_path,
                                    const std::string& vert_shader,
                                    const std::string& frag_shader) {
     // Load car model
-    car_model = std::make_unique<Model>(model_path);
+    car_model = std::make_unique<Model>(model_path, RENDER_COMPACT_VERTICES != 0);
     
     // Load car shader
     car_shader = std::make_unique<OGLShader>();
-    if (!car_shader->loadFromFile(vert_shader, frag_shader)) {
+    if (!car_shader->loadFromFile(vert_shader, frag_shader, shaderDefines(), cameraPreludePath(vert_shader))) {
         std::cerr << "Warning: Failed to load car shaders" << std::endl;
         car_model.reset();
         return;
     }
     
+    bindCameraBlock(*car_shader);
+    uniforms.car_model = car_shader->getUniformLocation("model");
+    
     // Setup car transform
     car_transform = glm::mat4(1.0f);
     car_transform = glm::translate(car_transform, glm::vec3(0.f, 1.01f, 0.f));
@@ -175,79 +507,682 @@ void SVRenderSimple::setupCarModel(const std::string& model_path,
     std::cout << "Car model loaded" << std::endl;
 }
 
-void SVRenderSimple::textureUpload(const cv::cuda::GpuMat& frame) {
-    if (frame.empty()) return;
+void SVRenderSimple::setupCameraBuffer() {
+    glGenBuffers(1, &camera_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
     
-    // Download from GPU to PBO using glMapBufferRange (OpenGL ES compatible)
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_id);
-    size_t buffer_size = OUTPUT_WIDTH * OUTPUT_HEIGHT * 3;
-    void* ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffer_size, 
-                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBufferBase(GL_UNIFORM_BUFFER, RENDER_CAMERA_BINDING, camera_ubo);
+}
+
+std::string SVRenderSimple::shaderDefines() {
+    std::ostringstream defines;
+    defines << "#define MAX_VIEWS " << RENDER_MAX_VIEWS << "\n";
     
-    if (ptr) {
-        frame.download(cv::Mat(OUTPUT_HEIGHT, OUTPUT_WIDTH, CV_8UC3, ptr));
-        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    // Bowl texture coordinates reach Bowl::uv_scale, the bowl shader undoes it to rebuild radius and angle
+    defines << "#define UV_SCALE " << std::showpoint << std::setprecision(9) << Bowl::uv_scale << "\n";
+    
+    if (RENDER_COMPACT_VERTICES) {
+        defines << "#define COMPACT_VERTICES\n";
+    }
+    return defines.str();
+}
+
+std::string SVRenderSimple::cameraPreludePath(const std::string& vert_shader) {
+    const size_t slash = vert_shader.find_last_of('/');
+    const std::string dir = (slash == std::string::npos) ? "" : vert_shader.substr(0, slash + 1);
+    return dir + "cameraviewvert.glsl";
+}
+
+void SVRenderSimple::updateCameraBlock() {
+    CameraBlock block;
+    
+    const float fov = glm::radians(camera.zoom);
+    block.view[0] = camera.getView();
+    
+    if (view_count == 1) {
+        block.projection[0] = glm::perspective(fov, aspect_ratio, 0.1f, 100.f);
+        block.viewport[0] = glm::vec4(1.f, 1.f, 0.f, 0.f);
+    } else {
+        // Top-down view above the bowl center, vehicle front up
+        block.view[1] = glm::lookAt(glm::vec3(0.f, RENDER_TOP_VIEW_HEIGHT, 0.f), glm::vec3(0.f),
+                                    glm::vec3(0.f, 0.f, -1.f));
+        
+        // Upper half of a 2x2 grid, or left and right halves without camera tiles
+        const float tile_aspect = camera_tiles ? aspect_ratio : 0.5f * aspect_ratio;
+        const float scale_y = camera_tiles ? 0.5f : 1.f;
+        const float offset_y = camera_tiles ? 0.5f : 0.f;
+        for (int i = 0; i < 2; i++) {
+            block.projection[i] = glm::perspective(fov, tile_aspect, 0.1f, 100.f);
+            block.viewport[i] = glm::vec4(0.5f, scale_y, i == 0 ? -0.5f : 0.5f, offset_y);
+        }
+    }
+    
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void SVRenderSimple::bindCameraBlock(const OGLShader& shader) const {
+    if (!shader.bindUniformBlock("Camera", RENDER_CAMERA_BINDING)) {
+        std::cerr << "Warning: shader program " << shader.ID << " has no Camera block" << std::endl;
+    }
+}
+
+void* SVRenderSimple::getProcAddress(const char* name) const {
+    if (headless) {
+        return reinterpret_cast<void*>(eglGetProcAddress(name));
+    }
+    return reinterpret_cast<void*>(glfwGetProcAddress(name));
+}
+
+bool SVRenderSimple::hasGLFeature(int major, int minor, const char* extension) const {
+    GLint context_major = 0, context_minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &context_major);
+    glGetIntegerv(GL_MINOR_VERSION, &context_minor);
+    if (context_major > major || (context_major == major && context_minor >= minor)) {
+        return true;
+    }
+    
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, extension) == 0) {
+            return true;
+        }
     }
+    return false;
+}
+
+void SVRenderSimple::setupTextureUpload() {
+    // Large enough for the stitched frame or all camera images
+    const size_t stitched_bytes = static_cast<size_t>(OUTPUT_WIDTH) * OUTPUT_HEIGHT * 3;
+    const size_t cameras_bytes = RENDER_DIRECT_PROJECTION ?
+        static_cast<size_t>(CAMERA_WIDTH) * CAMERA_HEIGHT * 3 * NUM_CAMERAS : 0;
+    pbo_size = std::max(stitched_bytes, cameras_bytes);
+    const GLsizeiptr buffer_size = pbo_size;
+    
+    // Immutable storage (GL 4.2 / ARB_texture_storage), allocated once
+    auto texStorage2D = hasGLFeature(4, 2, "GL_ARB_texture_storage") ?
+        reinterpret_cast<PFNGLTEXSTORAGE2DPROC>(getProcAddress("glTexStorage2D")) : nullptr;
     
-    // Upload to texture
+    glGenTextures(1, &texture_id);
     glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, OUTPUT_WIDTH, OUTPUT_HEIGHT,
-                 0, GL_BGR, GL_UNSIGNED_BYTE, 0);
+    if (texStorage2D) {
+        texStorage2D(GL_TEXTURE_2D, 1, GL_RGB8, OUTPUT_WIDTH, OUTPUT_HEIGHT);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, OUTPUT_WIDTH, OUTPUT_HEIGHT,
+                     0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    // Persistent coherent mapping (GL 4.4 / ARB_buffer_storage) if available,
+    // otherwise each buffer is mapped unsynchronized per frame
+    auto bufferStorage = hasGLFeature(4, 4, "GL_ARB_buffer_storage") ?
+        reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(getProcAddress("glBufferStorage")) : nullptr;
+    pbo_persistent = (bufferStorage != nullptr);
+    
+    const GLbitfield persistent_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    
+    glGenBuffers(RENDER_PBO_COUNT, pbo_ids);
+    for (int i = 0; i < RENDER_PBO_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ids[i]);
+        if (pbo_persistent) {
+            bufferStorage(GL_PIXEL_UNPACK_BUFFER, buffer_size, nullptr, persistent_flags);
+            pbo_ptrs[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffer_size, persistent_flags);
+            if (!pbo_ptrs[i]) {
+                std::cerr << "Persistent PBO mapping failed, using per-frame mapping" << std::endl;
+                pbo_persistent = false;
+            }
+        } else {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer_size, nullptr, GL_STREAM_DRAW);
+        }
+    }
+    
+    // Buffers created with glBufferStorage cannot be mapped per frame, start over
+    if (!pbo_persistent && bufferStorage) {
+        for (int i = 0; i < RENDER_PBO_COUNT; i++) {
+            if (pbo_ptrs[i]) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ids[i]);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                pbo_ptrs[i] = nullptr;
+            }
+        }
+        glDeleteBuffers(RENDER_PBO_COUNT, pbo_ids);
+        glGenBuffers(RENDER_PBO_COUNT, pbo_ids);
+        for (int i = 0; i < RENDER_PBO_COUNT; i++) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ids[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer_size, nullptr, GL_STREAM_DRAW);
+        }
+    }
+    
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void* SVRenderSimple::beginUpload() {
+    // The GPU may still be sourcing this PBO from an earlier frame; never wait for it,
+    // keep the previous texture contents instead
+    GLsync& fence = pbo_fences[pbo_index];
+    if (fence) {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            upload_stalls++;
+            return nullptr;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ids[pbo_index]);
     
+    void* ptr = pbo_ptrs[pbo_index];
+    if (!ptr) {
+        // Fence above guarantees the buffer is idle, no driver sync needed
+        ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, pbo_size,
+                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+    
+    if (!ptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    
+    return ptr;
+}
+
+void SVRenderSimple::endUpload() {
+    if (!pbo_persistent) {
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+}
+
+void SVRenderSimple::fenceUpload() {
+    pbo_fences[pbo_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pbo_index = (pbo_index + 1) % RENDER_PBO_COUNT;
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
-bool SVRenderSimple::render(const cv::cuda::GpuMat& stitched_texture) {
+void SVRenderSimple::textureUpload(const cv::cuda::GpuMat& frame) {
+    if (frame.empty()) return;
+    
+    if (frame.cols != OUTPUT_WIDTH || frame.rows != OUTPUT_HEIGHT || frame.type() != CV_8UC3) {
+        std::cerr << "Stitched frame " << frame.size() << " does not match texture "
+                  << OUTPUT_WIDTH << "x" << OUTPUT_HEIGHT << std::endl;
+        return;
+    }
+    
+    auto upload_start = std::chrono::steady_clock::now();
+    
+    void* ptr = beginUpload();
+    if (!ptr) return;
+    
+    // Download from CUDA into the PBO
+    frame.download(cv::Mat(OUTPUT_HEIGHT, OUTPUT_WIDTH, CV_8UC3, ptr));
+    endUpload();
+    
+    // Update the existing storage
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, OUTPUT_WIDTH, OUTPUT_HEIGHT,
+                    GL_BGR, GL_UNSIGNED_BYTE, 0);
+    
+    fenceUpload();
+    
+    last_upload_ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - upload_start).count();
+}
+
+void SVRenderSimple::cameraUpload(const std::array<cv::cuda::GpuMat, NUM_CAMERAS>& cameras) {
+    for (int i = 0; i < NUM_CAMERAS; i++) {
+        if (cameras[i].cols != CAMERA_WIDTH || cameras[i].rows != CAMERA_HEIGHT ||
+            cameras[i].type() != CV_8UC3) {
+            std::cerr << "Camera frame " << i << " " << cameras[i].size() << " does not match texture "
+                      << CAMERA_WIDTH << "x" << CAMERA_HEIGHT << std::endl;
+            return;
+        }
+    }
+    
+    auto upload_start = std::chrono::steady_clock::now();
+    
+    void* ptr = beginUpload();
+    if (!ptr) return;
+    
+    // Layers are packed back to back in the PBO
+    const size_t layer_bytes = static_cast<size_t>(CAMERA_WIDTH) * CAMERA_HEIGHT * 3;
+    for (int i = 0; i < NUM_CAMERAS; i++) {
+        cameras[i].download(cv::Mat(CAMERA_HEIGHT, CAMERA_WIDTH, CV_8UC3,
+                                    static_cast<uint8_t*>(ptr) + i * layer_bytes));
+    }
+    endUpload();
+    
+    glBindTexture(GL_TEXTURE_2D_ARRAY, camera_texture_id);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, CAMERA_WIDTH, CAMERA_HEIGHT, NUM_CAMERAS,
+                    GL_BGR, GL_UNSIGNED_BYTE, 0);
+    
+    fenceUpload();
+    
+    last_upload_ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - upload_start).count();
+}
+
+bool SVRenderSimple::setupDirectProjection(const std::vector<std::vector<float>>& projections,
+                                           const std::string& vert_shader,
+                                           const std::string& frag_shader) {
+    if (!is_init) return false;
+    
+    if (projections.size() != bowl_lods.size()) {
+        std::cerr << "Bowl projection has " << projections.size() << " LODs, bowl has "
+                  << bowl_lods.size() << std::endl;
+        return false;
+    }
+    
+    for (size_t i = 0; i < bowl_lods.size(); i++) {
+        if (projections[i].size() != bowl_lods[i].vertex_count * 12) {
+            std::cerr << "Bowl projection (LOD " << i << ") has " << projections[i].size() / 12
+                      << " vertices, bowl has " << bowl_lods[i].vertex_count << std::endl;
+            return false;
+        }
+    }
+    
+    if (!direct_shader.loadFromFile(vert_shader, frag_shader, shaderDefines(), cameraPreludePath(vert_shader))) {
+        std::cerr << "Failed to load direct projection shaders" << std::endl;
+        return false;
+    }
+    
+    bindCameraBlock(direct_shader);
+    direct_shader.useProgramm();
+    direct_shader.setInt("cameras", 0);
+    uniforms.direct_model = direct_shader.getUniformLocation("model");
+    uniforms.direct_gains = direct_shader.getUniformLocation("gains");
+    uniforms.direct_position_scale = direct_shader.getUniformLocation("positionScale");
+    uniforms.direct_position_offset = direct_shader.getUniformLocation("positionOffset");
+    
+    // Second vertex buffer on every bowl VAO
+    for (size_t i = 0; i < bowl_lods.size(); i++) {
+        BowlLod& lod = bowl_lods[i];
+        glBindVertexArray(lod.VAO);
+        
+        glGenBuffers(1, &lod.proj_VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, lod.proj_VBO);
+        glBufferData(GL_ARRAY_BUFFER, projections[i].size() * sizeof(float),
+                     projections[i].data(), GL_STATIC_DRAW);
+        
+        // Camera texcoords 0/1, 2/3 and weights
+        for (int k = 0; k < 3; k++) {
+            glVertexAttribPointer(2 + k, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float),
+                                  (void*)(4 * k * sizeof(float)));
+            glEnableVertexAttribArray(2 + k);
+        }
+    }
+    
+    glBindVertexArray(0);
+    
+    // One texture layer per camera
+    auto texStorage3D = hasGLFeature(4, 2, "GL_ARB_texture_storage") ?
+        reinterpret_cast<PFNGLTEXSTORAGE3DPROC>(getProcAddress("glTexStorage3D")) : nullptr;
+    
+    glGenTextures(1, &camera_texture_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, camera_texture_id);
+    if (texStorage3D) {
+        texStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGB8, CAMERA_WIDTH, CAMERA_HEIGHT, NUM_CAMERAS);
+    } else {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, CAMERA_WIDTH, CAMERA_HEIGHT, NUM_CAMERAS,
+                     0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    if (pbo_size < static_cast<size_t>(CAMERA_WIDTH) * CAMERA_HEIGHT * 3 * NUM_CAMERAS) {
+        std::cerr << "PBO ring too small for camera uploads (RENDER_DIRECT_PROJECTION off?)" << std::endl;
+        return false;
+    }
+    
+    direct_projection = true;
+    
+    std::cout << "Direct projection enabled: " << NUM_CAMERAS << " camera layers "
+              << CAMERA_WIDTH << "x" << CAMERA_HEIGHT << std::endl;
+    
+    return true;
+}
+
+bool SVRenderSimple::setupMultiView(const std::string& tile_vert, const std::string& tile_frag) {
+    if (!is_init) return false;
+    
+    view_count = 2;
+    camera_tiles = false;
+    
+    if (direct_projection) {
+        const int tile_cameras[2] = RENDER_MULTIVIEW_CAMERAS;
+        
+        if (tile_cameras[0] < 0 || tile_cameras[0] >= NUM_CAMERAS ||
+            tile_cameras[1] < 0 || tile_cameras[1] >= NUM_CAMERAS) {
+            std::cerr << "Invalid RENDER_MULTIVIEW_CAMERAS, camera tiles disabled" << std::endl;
+        } else if (!tile_shader.loadFromFile(tile_vert, tile_frag)) {
+            std::cerr << "Failed to load camera tile shaders, camera tiles disabled" << std::endl;
+        } else {
+            // Lower half of the 2x2 grid, layout is static
+            tile_shader.useProgramm();
+            tile_shader.setInt("cameras", 0);
+            tile_shader.setVec4("tileRect[0]", 0.5f, 0.5f, -0.5f, -0.5f);
+            tile_shader.setVec4("tileRect[1]", 0.5f, 0.5f, 0.5f, -0.5f);
+            tile_shader.setFloat("tileLayer[0]", static_cast<float>(tile_cameras[0]));
+            tile_shader.setFloat("tileLayer[1]", static_cast<float>(tile_cameras[1]));
+            
+            glGenVertexArrays(1, &tile_vao);
+            camera_tiles = true;
+        }
+    }
+    
+    std::cout << "Multi-view enabled: 3D + top view"
+              << (camera_tiles ? " + 2 camera tiles" : " (no camera tiles without direct projection)")
+              << std::endl;
+    
+    return true;
+}
+
+bool SVRenderSimple::setBowlShape(const BowlShape& shape) {
+    if (shape.a <= 0.0f || shape.b <= 0.0f || shape.c <= 0.0f ||
+        shape.disk_radius <= bowl_config.hole_radius || shape.disk_radius >= shape.outer_radius) {
+        std::cerr << "Invalid bowl shape: a=" << shape.a << " b=" << shape.b << " c=" << shape.c
+                  << " disk=" << shape.disk_radius << " outer=" << shape.outer_radius << std::endl;
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(bowl_shape_mutex);
+    bowl_shape = shape;
+    return true;
+}
+
+BowlShape SVRenderSimple::getBowlShape() const {
+    std::lock_guard<std::mutex> lock(bowl_shape_mutex);
+    return bowl_shape;
+}
+
+void SVRenderSimple::setObstacleDistance(float distance) {
+    std::lock_guard<std::mutex> lock(bowl_shape_mutex);
+    const float max_radius = BOWL_MAX_DISK_FRACTION * bowl_shape.outer_radius;
+    const float min_radius = std::min(std::max(BOWL_MIN_DISK_RADIUS, bowl_config.hole_radius * 1.5f), max_radius);
+    bowl_shape.disk_radius = std::min(std::max(distance, min_radius), max_radius);
+}
+
+bool SVRenderSimple::render(const SVRenderFrame& frame, bool upload) {
     if (!is_init) return false;
     
-    // Upload texture
-    textureUpload(stitched_texture);
+    auto render_start = std::chrono::steady_clock::now();
+    
+    if (headless) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo_id);
+    }
+    
+    // Upload texture(s)
+    if (upload) {
+        if (direct_projection) {
+            cameraUpload(frame.cameras);
+        } else {
+            textureUpload(frame.stitched);
+        }
+    }
     
     // Clear
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    // Setup matrices
-    glm::mat4 view = camera.getView();
-    glm::mat4 projection = glm::perspective(glm::radians(camera.zoom), 
-                                           aspect_ratio, 0.1f, 100.f);
+    // Setup matrices of all views (one buffer update, read by every program)
+    updateCameraBlock();
+    
+    // Each view is clipped to its own tile
+    if (view_count > 1) {
+        for (int i = 0; i < 4; i++) glEnable(GL_CLIP_DISTANCE0 + i);
+    }
     
     // Draw bowl with texture
     glm::mat4 bowl_model = bowl_config.transformation;
     bowl_model = glm::scale(bowl_model, glm::vec3(5.f, 5.f, 5.f));
     
-    bowl_shader.useProgramm();
-    bowl_shader.setMat4("model", bowl_model);
-    bowl_shader.setMat4("view", view);
-    bowl_shader.setMat4("projection", projection);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    bowl_shader.setInt("texture1", 0);
+    if (direct_projection) {
+        direct_shader.useProgramm();
+        direct_shader.setMat4(uniforms.direct_model, bowl_model);
+        
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, camera_texture_id);
+        direct_shader.setVec4(uniforms.direct_gains, frame.gains[0], frame.gains[1], frame.gains[2], frame.gains[3]);
+    } else {
+        bowl_shader.useProgramm();
+        bowl_shader.setMat4(uniforms.bowl_model, bowl_model);
+        
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+        
+        const BowlShape shape = getBowlShape();
+        bowl_shader.setVec4(uniforms.bowl_shape, shape.a, shape.b, shape.c, shape.disk_radius);
+        bowl_shader.setVec2(uniforms.bowl_extent, shape.outer_radius, bowl_floor_y);
+        bowl_shader.setVec3(uniforms.bowl_grid, bowl_config.hole_radius, bowl_config.disk_radius,
+                            bowl_config.parab_radius);
+    }
     
-    glBindVertexArray(bowl_VAO);
-    glDrawElements(GL_TRIANGLE_STRIP, bowl_index_count, GL_UNSIGNED_INT, 0);
+    if (!bowl_lods.empty()) {
+        const int lod_index = selectBowlLod(bowl_model);
+        const BowlLod& lod = bowl_lods[lod_index];
+        
+        if (direct_projection && RENDER_COMPACT_VERTICES) {
+            const PositionDequant& dq = lod.position_dequant;
+            direct_shader.setVec3(uniforms.direct_position_scale, dq.scale.x, dq.scale.y, dq.scale.z);
+            direct_shader.setVec3(uniforms.direct_position_offset, dq.offset.x, dq.offset.y, dq.offset.z);
+        }
+        
+        // Restart is enabled only here: 0xFFFF is a valid index in the car's 32-bit buffers
+        glEnable(GL_PRIMITIVE_RESTART);
+        
+        glBindVertexArray(lod.VAO);
+        for (const BowlIndexChunk& chunk : lod.chunks) {
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLE_STRIP, chunk.index_count, GL_UNSIGNED_SHORT,
+                                              (void*)(chunk.index_offset * sizeof(uint16_t)),
+                                              view_count, chunk.base_vertex);
+        }
+        
+        glDisable(GL_PRIMITIVE_RESTART);
+        
+        last_bowl_lod = lod_index;
+        last_bowl_vertices = lod.vertex_count;
+    }
     
-    // Draw car model if loaded (OGLShader doesn't need casting - it's compatible)
+    // Draw car model if loaded
     if (car_model && car_shader) {
         car_shader->useProgramm();
-        car_shader->setMat4("model", car_transform);
-        car_shader->setMat4("view", view);
-        car_shader->setMat4("projection", projection);
+        car_shader->setMat4(uniforms.car_model, car_transform);
         
-        // OGLShader has the same interface as Shader, no cast needed
-        // Just call Draw with the dereferenced shader
-        Shader& shader_ref = *reinterpret_cast<Shader*>(car_shader.get());
-        car_model->Draw(shader_ref);
+        // One draw call per material batch, instanced per view
+        car_model->Draw(car_shader->ID, view_count);
     }
     
-    // Swap buffers
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+    if (view_count > 1) {
+        for (int i = 0; i < 4; i++) glDisable(GL_CLIP_DISTANCE0 + i);
+    }
+    
+    // Raw camera tiles from the already uploaded camera layers
+    if (camera_tiles) {
+        glDisable(GL_DEPTH_TEST);
+        tile_shader.useProgramm();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, camera_texture_id);
+        glBindVertexArray(tile_vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 2);
+        glBindVertexArray(0);
+        glEnable(GL_DEPTH_TEST);
+    }
+    
+    if (readback_callback) {
+        readbackFrame();
+    }
+    
+    // Swap buffers (headless: wait for the GPU so the timing covers the whole frame)
+    if (window) {
+        glfwSwapBuffers(window);
+    } else {
+        glFinish();
+    }
+    
+    last_render_ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - render_start).count();
     
     return true;
 }
 
+bool SVRenderSimple::attachContext(int swap_interval) {
+    if (window) {
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(swap_interval);
+        return true;
+    }
+    
+    if (egl_display != EGL_NO_DISPLAY &&
+        eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context)) {
+        return true;
+    }
+    
+    std::cerr << "Failed to make GL context current" << std::endl;
+    return false;
+}
+
+void SVRenderSimple::detachContext() {
+    if (window) {
+        glfwMakeContextCurrent(nullptr);
+    } else if (egl_display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+}
+
+void SVRenderSimple::pollEvents() {
+    if (window) {
+        glfwPollEvents();
+    }
+}
+
+void SVRenderSimple::waitEvents(int timeout_ms) {
+    if (window) {
+        glfwWaitEventsTimeout(timeout_ms / 1000.0);
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    }
+}
+
 bool SVRenderSimple::shouldClose() const {
     return window && glfwWindowShouldClose(window);
+}
+
+bool SVRenderSimple::readFrame(cv::Mat& frame) {
+    if (!is_init) return false;
+    
+    cv::Mat rgba(screen_height, screen_width, CV_8UC4);
+    
+    if (headless) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_id);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+    } else {
+        glReadBuffer(GL_BACK);
+    }
+    
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, screen_width, screen_height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data);
+    
+    // OpenGL rows start at the bottom
+    cv::flip(rgba, rgba, 0);
+    cv::cvtColor(rgba, frame, cv::COLOR_RGBA2BGR);
+    
+    return true;
+}
+
+void SVRenderSimple::setReadbackCallback(SVReadbackCallback callback) {
+    readback_callback = std::move(callback);
+}
+
+void SVRenderSimple::readbackFrame() {
+    auto readback_start = std::chrono::steady_clock::now();
+    const GLsizeiptr frame_bytes = static_cast<GLsizeiptr>(screen_width) * screen_height * 4;
+    
+    if (readback_pbos[0] == 0) {
+        glGenBuffers(RENDER_READBACK_PBO_COUNT, readback_pbos);
+        for (int i = 0; i < RENDER_READBACK_PBO_COUNT; i++) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_pbos[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frame_bytes, nullptr, GL_STREAM_READ);
+        }
+    }
+    
+    // Deliver finished buffers, oldest first; never wait for the GPU
+    while (readback_pending > 0) {
+        const int tail = (readback_head - readback_pending + RENDER_READBACK_PBO_COUNT) % RENDER_READBACK_PBO_COUNT;
+        GLenum status = glClientWaitSync(readback_fences[tail], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        glDeleteSync(readback_fences[tail]);
+        readback_fences[tail] = nullptr;
+        readback_pending--;
+        
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_pbos[tail]);
+        void* ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame_bytes, GL_MAP_READ_BIT);
+        if (ptr) {
+            readback_callback(cv::Mat(screen_height, screen_width, CV_8UC4, ptr), readback_numbers[tail]);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+    }
+    
+    // Queue this frame; all buffers in flight means the consumer side is behind, skip it
+    const unsigned long number = readback_counter++;
+    if (readback_pending == RENDER_READBACK_PBO_COUNT) {
+        readback_drops++;
+    } else {
+        if (headless) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_id);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+        } else {
+            glReadBuffer(GL_BACK);
+        }
+        
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_pbos[readback_head]);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, screen_width, screen_height, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+        readback_fences[readback_head] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback_numbers[readback_head] = number;
+        readback_head = (readback_head + 1) % RENDER_READBACK_PBO_COUNT;
+        readback_pending++;
+    }
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    
+    last_readback_ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - readback_start).count();
+}
+
+void SVRenderSimple::releaseReadback() {
+    for (int i = 0; i < RENDER_READBACK_PBO_COUNT; i++) {
+        if (readback_fences[i]) {
+            glDeleteSync(readback_fences[i]);
+            readback_fences[i] = nullptr;
+        }
+    }
+    if (readback_pbos[0]) {
+        glDeleteBuffers(RENDER_READBACK_PBO_COUNT, readback_pbos);
+        for (int i = 0; i < RENDER_READBACK_PBO_COUNT; i++) {
+            readback_pbos[i] = 0;
+        }
+    }
+    readback_pending = 0;
+}
+
+bool SVRenderSimple::saveFrame(const std::string& path) {
+    cv::Mat frame;
+    if (!readFrame(frame)) return false;
+    
+    if (!cv::imwrite(path, frame)) {
+        std::cerr << "Failed to write frame: " << path << std::endl;
+        return false;
+    }
+    
+    return true;
 }
\ No newline at end of file
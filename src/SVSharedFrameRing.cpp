@@ -0,0 +1,345 @@
+#include "SVSharedFrameRing.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <new>
+
+namespace {
+
+const char RING_MAGIC[8] = { 'S', 'V', 'S', 'H', 'M', 'R', 'N', 'G' };
+const size_t PAGE_ALIGNMENT = 4096;
+
+size_t alignUp(const size_t offset) {
+    return (offset + PAGE_ALIGNMENT - 1) / PAGE_ALIGNMENT * PAGE_ALIGNMENT;
+}
+
+// Process-shared futex on a word inside the mapping
+long futex(std::atomic<uint32_t>* word, int op, uint32_t value, const timespec* timeout) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain uint32_t");
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+}
+
+} // namespace
+
+uint64_t svShmNowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// ============================================================================
+// SVShmFramePublisher
+// ============================================================================
+
+SVShmFramePublisher::SVShmFramePublisher()
+    : mapped(nullptr), mapped_size(0), header(nullptr), slots(nullptr),
+      next_sequence(1), writing(false) {
+}
+
+SVShmFramePublisher::~SVShmFramePublisher() {
+    close();
+}
+
+bool SVShmFramePublisher::init(const std::string& name, uint32_t width, uint32_t height, uint32_t channels,
+                               uint32_t slot_count) {
+    close();
+
+    if (slot_count < 2 || width == 0 || height == 0 || channels == 0) {
+        std::cerr << "Shared ring: invalid layout " << width << "x" << height << "x" << channels
+                  << ", " << slot_count << " slots" << std::endl;
+        return false;
+    }
+
+    const uint32_t stride = width * channels;
+    const uint64_t frame_bytes = static_cast<uint64_t>(stride) * height;
+    const size_t slot_offset = alignUp(sizeof(SVShmRingHeader) + slot_count * sizeof(SVShmSlotHeader));
+    const size_t slot_pitch = alignUp(frame_bytes);
+    const size_t total_size = slot_offset + slot_count * slot_pitch;
+
+    // Readers of a previous run keep their old mapping and see it closed
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd < 0) {
+        std::cerr << "Shared ring: shm_open failed for " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(total_size)) != 0) {
+        std::cerr << "Shared ring: cannot size " << name << " to " << total_size << " bytes" << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* data = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        std::cerr << "Shared ring: mmap failed for " << name << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    shm_name = name;
+    mapped = data;
+    mapped_size = total_size;
+
+    // ftruncate zero-fills: all seqlocks even, no frame published
+    header = new (mapped) SVShmRingHeader();
+    std::memcpy(header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+    header->version = SV_SHM_RING_VERSION;
+    header->slot_count = slot_count;
+    header->width = width;
+    header->height = height;
+    header->channels = channels;
+    header->stride = stride;
+    header->frame_bytes = frame_bytes;
+    header->slot_offset = slot_offset;
+    header->slot_pitch = slot_pitch;
+
+    slots = reinterpret_cast<SVShmSlotHeader*>(static_cast<uint8_t*>(mapped) + sizeof(SVShmRingHeader));
+    for (uint32_t i = 0; i < slot_count; i++) {
+        new (&slots[i]) SVShmSlotHeader();
+    }
+
+    next_sequence = 1;
+    writing = false;
+    header->ready.store(1, std::memory_order_release);
+
+    std::cout << "Shared ring " << name << ": " << slot_count << " x " << width << "x" << height
+              << "x" << channels << " (" << total_size / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+uint8_t* SVShmFramePublisher::beginWrite() {
+    if (!header) return nullptr;
+
+    const uint32_t slot = static_cast<uint32_t>((next_sequence - 1) % header->slot_count);
+    SVShmSlotHeader& entry = slots[slot];
+
+    // Odd: readers of the previous frame in this slot see it torn from here on
+    if (!writing) {
+        entry.seqlock.store(entry.seqlock.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        writing = true;
+    }
+
+    return static_cast<uint8_t*>(mapped) + header->slot_offset + slot * header->slot_pitch;
+}
+
+uint64_t SVShmFramePublisher::endWrite(uint64_t capture_ns) {
+    if (!header || !writing) return 0;
+
+    const uint64_t sequence = next_sequence++;
+    const uint32_t slot = static_cast<uint32_t>((sequence - 1) % header->slot_count);
+    SVShmSlotHeader& entry = slots[slot];
+
+    entry.sequence.store(sequence, std::memory_order_relaxed);
+    entry.capture_ns.store(capture_ns, std::memory_order_relaxed);
+    entry.publish_ns.store(svShmNowNs(), std::memory_order_relaxed);
+    entry.seqlock.store(entry.seqlock.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    writing = false;
+
+    header->latest.store(sequence, std::memory_order_release);
+    header->frame_counter.fetch_add(1, std::memory_order_release);
+    if (header->waiters.load(std::memory_order_acquire) > 0) {
+        futex(&header->frame_counter, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+
+    return sequence;
+}
+
+uint8_t* SVShmFramePublisher::getFrameData() const {
+    return header ? static_cast<uint8_t*>(mapped) + header->slot_offset : nullptr;
+}
+
+size_t SVShmFramePublisher::getFrameDataSize() const {
+    return header ? mapped_size - header->slot_offset : 0;
+}
+
+void SVShmFramePublisher::close() {
+    if (!mapped) return;
+
+    // Wake blocked readers so they notice
+    header->closed.store(1, std::memory_order_release);
+    header->frame_counter.fetch_add(1, std::memory_order_release);
+    futex(&header->frame_counter, FUTEX_WAKE, INT_MAX, nullptr);
+
+    munmap(mapped, mapped_size);
+    shm_unlink(shm_name.c_str());
+    mapped = nullptr;
+    mapped_size = 0;
+    header = nullptr;
+    slots = nullptr;
+}
+
+// ============================================================================
+// SVShmFrameReader
+// ============================================================================
+
+SVShmFrameReader::SVShmFrameReader()
+    : mapped(nullptr), mapped_size(0), header(nullptr), slots(nullptr),
+      last_sequence(0), acquire_counter(0), skipped_frames(0) {
+}
+
+SVShmFrameReader::~SVShmFrameReader() {
+    close();
+}
+
+bool SVShmFrameReader::open(const std::string& name) {
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SVShmRingHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        std::cerr << "Shared ring: mmap failed for " << name << std::endl;
+        return false;
+    }
+
+    auto* ring = static_cast<SVShmRingHeader*>(data);
+    if (!ring->ready.load(std::memory_order_acquire) ||
+        std::memcmp(ring->magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0 ||
+        ring->version != SV_SHM_RING_VERSION ||
+        ring->slot_offset + static_cast<uint64_t>(ring->slot_count) * ring->slot_pitch > size) {
+        munmap(data, size);
+        return false;
+    }
+
+    mapped = data;
+    mapped_size = size;
+    header = ring;
+    slots = reinterpret_cast<SVShmSlotHeader*>(static_cast<uint8_t*>(mapped) + sizeof(SVShmRingHeader));
+
+    // Start from the current frame, not from the beginning of the ring
+    last_sequence = 0;
+    acquire_counter = ring->frame_counter.load(std::memory_order_acquire);
+    skipped_frames = 0;
+    return true;
+}
+
+void SVShmFrameReader::close() {
+    if (mapped) {
+        munmap(mapped, mapped_size);
+        mapped = nullptr;
+        mapped_size = 0;
+    }
+    header = nullptr;
+    slots = nullptr;
+}
+
+bool SVShmFrameReader::acquireLatest(View& view) {
+    if (!header) return false;
+
+    // Before latest: a publish after the check below moves the counter past this value
+    acquire_counter = header->frame_counter.load(std::memory_order_acquire);
+    const uint64_t sequence = header->latest.load(std::memory_order_acquire);
+    if (sequence == 0 || sequence == last_sequence) {
+        return false;
+    }
+
+    const uint32_t slot = static_cast<uint32_t>((sequence - 1) % header->slot_count);
+    const SVShmSlotHeader& entry = slots[slot];
+
+    const uint32_t lock = entry.seqlock.load(std::memory_order_acquire);
+    if ((lock & 1) != 0 || entry.sequence.load(std::memory_order_relaxed) != sequence) {
+        // Already being overwritten: the publisher went round the ring since reading latest
+        return false;
+    }
+
+    view.data = static_cast<const uint8_t*>(mapped) + header->slot_offset + slot * header->slot_pitch;
+    view.sequence = sequence;
+    view.capture_ns = entry.capture_ns.load(std::memory_order_relaxed);
+    view.publish_ns = entry.publish_ns.load(std::memory_order_relaxed);
+    view.slot = slot;
+    view.seqlock = lock;
+
+    if (last_sequence != 0 && sequence > last_sequence + 1) {
+        skipped_frames += sequence - last_sequence - 1;
+    }
+    last_sequence = sequence;
+
+    return isValid(view);
+}
+
+bool SVShmFrameReader::isValid(const View& view) const {
+    if (!header) return false;
+
+    // Data reads above must not move past the second seqlock load
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slots[view.slot].seqlock.load(std::memory_order_relaxed) == view.seqlock;
+}
+
+bool SVShmFrameReader::waitForFrame(int timeout_ms) {
+    return wait(timeout_ms, false);
+}
+
+bool SVShmFrameReader::waitForPublish(int timeout_ms) {
+    return wait(timeout_ms, true);
+}
+
+bool SVShmFrameReader::wait(int timeout_ms, bool any_publish) {
+    if (!header) return false;
+
+    const uint64_t deadline = svShmNowNs() + static_cast<uint64_t>(timeout_ms) * 1000000ull;
+
+    header->waiters.fetch_add(1, std::memory_order_acq_rel);
+    bool available = false;
+
+    while (true) {
+        // Read the futex word first, so a publish after the check still wakes us
+        const uint32_t counter = header->frame_counter.load(std::memory_order_acquire);
+        const uint64_t latest = header->latest.load(std::memory_order_acquire);
+        const bool published = any_publish ? counter != acquire_counter
+                                           : latest != 0 && latest != last_sequence;
+        if (published || header->closed.load(std::memory_order_acquire)) {
+            available = published;
+            break;
+        }
+
+        const uint64_t now = svShmNowNs();
+        if (now >= deadline) {
+            break;
+        }
+
+        timespec timeout;
+        timeout.tv_sec = static_cast<time_t>((deadline - now) / 1000000000ull);
+        timeout.tv_nsec = static_cast<long>((deadline - now) % 1000000000ull);
+        futex(&header->frame_counter, FUTEX_WAIT, counter, &timeout);
+    }
+
+    header->waiters.fetch_sub(1, std::memory_order_acq_rel);
+    return available;
+}
+
+uint8_t* SVShmFrameReader::getFrameData() const {
+    return header ? static_cast<uint8_t*>(mapped) + header->slot_offset : nullptr;
+}
+
+size_t SVShmFrameReader::getFrameDataSize() const {
+    return header ? mapped_size - header->slot_offset : 0;
+}
+
+bool SVShmFrameReader::isPublisherClosed() const {
+    return header && header->closed.load(std::memory_order_acquire) != 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * SVSharedMemoryCamera.cpp
+ * Camera frames from shared-memory rings written by an external decoder
+ */
+
+#include "SVSharedMemoryCamera.hpp"
+#include "SVConfig.hpp"
+#include <opencv2/cudaimgproc.hpp>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+// Logging macros (matching SVEthernetCamera.cpp)
+#define LOG_DEBUG(msg, ...)   printf("DEBUG:   " msg "\n", ##__VA_ARGS__)
+#define LOG_WARNING(msg, ...) printf("WARNING: " msg "\n", ##__VA_ARGS__)
+#define LOG_ERROR(msg, ...)   printf("ERROR:   " msg "\n", ##__VA_ARGS__)
+
+using namespace std::chrono_literals;
+
+SharedMemoryCameraSource::SharedMemoryCameraSource(const std::string& ringPrefix)
+    : MultiCameraSource(false)
+    , ringPrefix(ringPrefix)
+    , tornFrames(0)
+    , lastSkewNs(0)
+{
+    pinned.fill(false);
+    captureNs.fill(0);
+}
+
+SharedMemoryCameraSource::~SharedMemoryCameraSource() {
+    close();
+}
+
+int SharedMemoryCameraSource::init(const std::string& param_filepath, const cv::Size& calibSize,
+                                   const cv::Size& undistSize, const bool useUndist)
+{
+    LOG_DEBUG("Initializing shared-memory camera source (%s0..%d)...", ringPrefix.c_str(), CAM_NUMS - 1);
+
+    frameSize = undistSize;
+    _undistort = useUndist;
+
+    // Rings may appear later, they are opened by startStream() / capture()
+    initUndistortion(param_filepath, calibSize, undistSize);
+
+    return 0;
+}
+
+bool SharedMemoryCameraSource::openRing(size_t idx) {
+    closeRing(idx);
+
+    const std::string name = ringPrefix + std::to_string(idx);
+    if (!readers[idx].open(name)) {
+        return false;
+    }
+
+    const SVShmRingHeader* header = readers[idx].getHeader();
+    if (header->channels != 3 && header->channels != 4) {
+        LOG_ERROR("Ring %s: %u channels, expected BGR or BGRA", name.c_str(), header->channels);
+        readers[idx].close();
+        return false;
+    }
+
+    if (static_cast<int>(header->width) != frameSize.width || static_cast<int>(header->height) != frameSize.height) {
+        LOG_ERROR("Ring %s: frames are %ux%u, expected %dx%d",
+                  name.c_str(), header->width, header->height, frameSize.width, frameSize.height);
+        readers[idx].close();
+        return false;
+    }
+
+    // Page-locked slots upload without a staging copy
+    pinned[idx] = cudaHostRegister(readers[idx].getFrameData(), readers[idx].getFrameDataSize(),
+                                   cudaHostRegisterDefault) == cudaSuccess;
+    if (!pinned[idx]) {
+        cudaGetLastError();
+        LOG_WARNING("Ring %s could not be page-locked, uploads are staged", name.c_str());
+    }
+
+    LOG_DEBUG("Camera %zu attached to %s: %ux%ux%u, %u slots",
+              idx, name.c_str(), header->width, header->height, header->channels, header->slot_count);
+    return true;
+}
+
+void SharedMemoryCameraSource::closeRing(size_t idx) {
+    if (pinned[idx]) {
+        cudaHostUnregister(readers[idx].getFrameData());
+        pinned[idx] = false;
+    }
+    readers[idx].close();
+}
+
+bool SharedMemoryCameraSource::startStream() {
+    LOG_DEBUG("Attaching to camera rings...");
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SHM_INPUT_TIMEOUT_MS);
+    bool allOpen = false;
+
+    while (!allOpen) {
+        allOpen = true;
+        for (size_t i = 0; i < CAM_NUMS; ++i) {
+            if (!readers[i].isOpen()) {
+                allOpen &= openRing(i);
+            }
+        }
+
+        if (!allOpen) {
+            if (std::chrono::steady_clock::now() >= deadline) break;
+            std::this_thread::sleep_for(100ms);
+        }
+    }
+
+    if (!allOpen) {
+        LOG_ERROR("Camera rings %s* not available (producer not running?)", ringPrefix.c_str());
+    }
+
+    return allOpen;
+}
+
+bool SharedMemoryCameraSource::stopStream() {
+    for (size_t i = 0; i < CAM_NUMS; ++i) {
+        closeRing(i);
+    }
+    return true;
+}
+
+bool SharedMemoryCameraSource::captureCamera(size_t idx) {
+    SVShmFrameReader& reader = readers[idx];
+
+    // Producer restarted: follow its new ring
+    if (!reader.isOpen() || reader.isPublisherClosed()) {
+        if (!openRing(idx)) {
+            return false;
+        }
+    }
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!reader.waitForFrame(SHM_INPUT_TIMEOUT_MS)) {
+            LOG_WARNING("No frame from camera ring %zu", idx);
+            return false;
+        }
+
+        SVShmFrameReader::View view;
+        if (!reader.acquireLatest(view)) {
+            // Slot already being overwritten: retry once the publisher has completed it
+            if (!reader.waitForPublish(SHM_INPUT_TIMEOUT_MS)) {
+                LOG_WARNING("No frame from camera ring %zu", idx);
+                return false;
+            }
+            continue;
+        }
+
+        // Upload straight from the ring slot
+        const SVShmRingHeader* header = reader.getHeader();
+        cv::Mat slot(header->height, header->width, CV_8UC(header->channels),
+                     const_cast<uint8_t*>(view.data), header->stride);
+
+        if (header->channels == 4) {
+            uploadFrames[idx].upload(slot);
+            cv::cuda::cvtColor(uploadFrames[idx], rawFrames[idx], cv::COLOR_BGRA2BGR);
+        } else {
+            rawFrames[idx].upload(slot);
+        }
+
+        if (reader.isValid(view)) {
+            captureNs[idx] = view.capture_ns;
+            return true;
+        }
+
+        // Overwritten during the upload, take the next frame
+        tornFrames++;
+    }
+
+    return false;
+}
+
+bool SharedMemoryCameraSource::capture(std::array<Frame, CAM_NUMS>& frames) {
+    bool allCaptured = true;
+
+    for (size_t i = 0; i < CAM_NUMS; ++i) {
+        if (!captureCamera(i)) {
+            frames[i].gpuFrame = cv::cuda::GpuMat();
+            allCaptured = false;
+            continue;
+        }
+
+        undistortFrame(i, rawFrames[i], frames[i]);
+    }
+
+    if (allCaptured) {
+        auto range = std::minmax_element(captureNs.begin(), captureNs.end());
+        lastSkewNs = *range.second - *range.first;
+    }
+
+    return allCaptured;
+}
+
+bool SharedMemoryCameraSource::setFrameSize(const cv::Size& size) {
+    frameSize = size;
+    return true;
+}
+
+uint64_t SharedMemoryCameraSource::getSkippedCount() const {
+    uint64_t skipped = 0;
+    for (const auto& reader : readers) {
+        skipped += reader.getSkippedCount();
+    }
+    return skipped;
+}
+
+void SharedMemoryCameraSource::close() {
+    stopStream();
+}
@@ -1,8 +1,12 @@
 #include "SVStitcherSimple.hpp"
 #include <opencv2/calib3d.hpp>
 #include <opencv2/stitching/detail/warpers.hpp>
+#include <opencv2/stitching/detail/util.hpp>
 #include <opencv2/cudawarping.hpp>
 #include <opencv2/cudaimgproc.hpp>
+#include <opencv2/cudaarithm.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 SVStitcherSimple::SVStitcherSimple() 
@@ -45,36 +49,32 @@ bool SVStitcherSimple::initFromFiles(const std::string& calib_folder,
         return false;
     }
     
-    // Initialize blender
-    blender = std::make_shared<SVMultiBandBlender>(NUM_BLEND_BANDS);
+    // Initialize blender (keeps a Gaussian level of every camera for gain statistics)
+    blender = std::make_shared<SVMultiBandBlender>(NUM_BLEND_BANDS, GAIN_STATS_LEVEL);
     blender->prepare(warp_corners, warp_sizes, blend_masks);
     
     std::cout << "Multi-band blender initialized (" << NUM_BLEND_BANDS << " bands)" << std::endl;
     
-    // Initialize gain compensator
+    // Initialize gain compensator (unit gains until the first estimate)
     gain_comp = std::make_shared<SVGainCompensator>(num_cameras);
     
-    // Create sample warped frames for gain initialization
-    std::vector<cv::cuda::GpuMat> warped_samples(num_cameras);
-    for (int i = 0; i < num_cameras; i++) {
-        cv::cuda::GpuMat scaled;
-        cv::cuda::resize(sample_frames[i], scaled, cv::Size(),
-                        scale_factor, scale_factor, cv::INTER_LINEAR);
-        cv::cuda::remap(scaled, warped_samples[i],
-                       warp_x_maps[i], warp_y_maps[i],
-                       cv::INTER_LINEAR, cv::BORDER_CONSTANT);
-    }
-    
-    gain_comp->init(warped_samples, warp_corners, blend_masks);
-    
-    std::cout << "Gain compensator initialized" << std::endl;
-    
     // Setup output cropping
     if (!setupOutputCrop(calib_folder)) {
         return false;
     }
     
     is_init = true;
+    
+    // Stitch the sample frames once to fill the blender pyramids, then estimate gains from them
+    cv::cuda::GpuMat sample_output;
+    if (!stitch(sample_frames, sample_output)) {
+        is_init = false;
+        return false;
+    }
+    
+    recomputeGain();
+    
+    std::cout << "Gain compensator initialized (pyramid level " << GAIN_STATS_LEVEL << ")" << std::endl;
     std::cout << "✓ Stitcher initialization complete!" << std::endl;
     
     return true;
@@ -238,10 +238,10 @@ bool SVStitcherSimple::setupOutputCrop(const std::string& folder) {
         cv::Point2f(output_size.width, output_size.height)
     };
     
-    cv::Mat transform = cv::getPerspectiveTransform(src_pts, dst_pts);
+    crop_transform = cv::getPerspectiveTransform(src_pts, dst_pts);
     
     // Build GPU warp maps
-    cv::cuda::buildWarpPerspectiveMaps(transform, false, output_size, 
+    cv::cuda::buildWarpPerspectiveMaps(crop_transform, false, output_size, 
                                         crop_warp_x, crop_warp_y);
     
     return true;
@@ -300,25 +300,158 @@ bool SVStitcherSimple::stitch(const std::vector<cv::cuda::GpuMat>& frames,
     return true;
 }
 
-void SVStitcherSimple::recomputeGain(const std::vector<cv::cuda::GpuMat>& frames) {
+void SVStitcherSimple::recomputeGain() {
     if (!is_init || !gain_comp) {
         return;
     }
     
-    // Create warped frames for gain computation
-    std::vector<cv::cuda::GpuMat> warped_frames(num_cameras);
+    // Reuse the Gaussian level the blender built during the last stitch()
+    std::vector<cv::cuda::GpuMat> levels, level_masks;
+    std::vector<cv::Point> level_corners;
+    
+    if (!blender->getStatsLevel(levels, level_masks, level_corners)) {
+        std::cerr << "WARNING: No blender statistics available for gain update" << std::endl;
+        return;
+    }
     
+    std::vector<cv::cuda::GpuMat> levels_8u(num_cameras);
     for (int i = 0; i < num_cameras; i++) {
-        cv::cuda::GpuMat scaled_frame;
-        cv::cuda::resize(frames[i], scaled_frame, cv::Size(),
-                        scale_factor, scale_factor, cv::INTER_LINEAR);
-        
-        cv::cuda::remap(scaled_frame, warped_frames[i],
-                       warp_x_maps[i], warp_y_maps[i],
-                       cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+        levels[i].convertTo(levels_8u[i], CV_8UC3);
     }
     
-    gain_comp->recompute(warped_frames, warp_corners, blend_masks);
+    // Levels are already gain compensated, so the estimate refines the current gains
+    gain_comp->update(levels_8u, level_corners, level_masks);
     
     std::cout << "Gain compensation updated" << std::endl;
 }
+
+bool SVStitcherSimple::measureLuma(std::vector<double>& lumas) {
+    if (!is_init || !gain_comp) {
+        return false;
+    }
+    
+    std::vector<cv::cuda::GpuMat> levels, level_masks;
+    std::vector<cv::Point> level_corners;
+    
+    if (!blender->getStatsLevel(levels, level_masks, level_corners)) {
+        return false;
+    }
+    
+    // Masks are static, count their pixels once
+    if (luma_pixel_counts.empty()) {
+        for (int i = 0; i < num_cameras; i++) {
+            luma_pixel_counts.push_back(cv::cuda::countNonZero(level_masks[i]));
+        }
+    }
+    
+    lumas.resize(num_cameras);
+    for (int i = 0; i < num_cameras; i++) {
+        cv::Scalar bgr = cv::cuda::sum(levels[i], level_masks[i]);
+        double luma = 0.114 * bgr[0] + 0.587 * bgr[1] + 0.299 * bgr[2];
+        lumas[i] = luma / std::max(luma_pixel_counts[i], 1) / gain_comp->getGain(i);
+    }
+    
+    return true;
+}
+
+bool SVStitcherSimple::computeBowlProjection(const std::vector<float>& vertices, const int stride,
+                                             const int uv_offset, std::vector<float>& projection) const {
+    if (!is_init) {
+        return false;
+    }
+    
+    if (num_cameras != 4) {
+        std::cerr << "ERROR: Direct projection needs 4 cameras (have " << num_cameras << ")" << std::endl;
+        return false;
+    }
+    
+    // Output pixel -> panorama pixel
+    const cv::Rect pano_roi = cv::detail::resultRoi(warp_corners, warp_sizes);
+    cv::Matx33d out_to_pano;
+    if (!crop_transform.empty()) {
+        out_to_pano = cv::Matx33d(crop_transform).inv();
+    } else {
+        out_to_pano = cv::Matx33d(static_cast<double>(pano_roi.width) / output_size.width, 0, 0,
+                                  0, static_cast<double>(pano_roi.height) / output_size.height, 0,
+                                  0, 0, 1);
+    }
+    
+    // Same projection as the warp maps: spherical coords at scale s, scaled K
+    const float scale = scale_factor * focal_length;
+    const cv::Size scaled_input(CAMERA_WIDTH * scale_factor, CAMERA_HEIGHT * scale_factor);
+    
+    std::vector<cv::Matx33f> K_Rinv(num_cameras);
+    for (int i = 0; i < num_cameras; i++) {
+        cv::Mat K_scaled = K_matrices[i].clone();
+        K_scaled.at<float>(0, 0) *= scale_factor;
+        K_scaled.at<float>(1, 1) *= scale_factor;
+        K_scaled.at<float>(0, 2) *= scale_factor;
+        K_scaled.at<float>(1, 2) *= scale_factor;
+        
+        cv::Mat R;
+        R_matrices[i].convertTo(R, CV_32F);
+        K_Rinv[i] = cv::Matx33f(cv::Mat(K_scaled * R.t()));
+    }
+    
+    const size_t vertex_count = vertices.size() / stride;
+    projection.assign(vertex_count * 12, 0.0f);
+    
+    int covered = 0;
+    for (size_t k = 0; k < vertex_count; k++) {
+        const float u = vertices[k * stride + uv_offset];
+        const float v = vertices[k * stride + uv_offset + 1];
+        
+        cv::Vec3d pano = out_to_pano * cv::Vec3d(u * output_size.width, v * output_size.height, 1.0);
+        const float wx = static_cast<float>(pano[0] / pano[2]) + pano_roi.x;
+        const float wy = static_cast<float>(pano[1] / pano[2]) + pano_roi.y;
+        
+        // cv::detail::SphericalProjector::mapBackward
+        const float theta = wx / scale;
+        const float phi = wy / scale;
+        const float sinv = std::sin(static_cast<float>(CV_PI) - phi);
+        const cv::Vec3f ray(sinv * std::sin(theta), std::cos(static_cast<float>(CV_PI) - phi), sinv * std::cos(theta));
+        
+        float* out = &projection[k * 12];
+        float* weights = out + 8;
+        
+        for (int i = 0; i < num_cameras; i++) {
+            cv::Vec3f p = K_Rinv[i] * ray;
+            if (p[2] <= 0.0f) {
+                continue;
+            }
+            
+            const float cx = p[0] / p[2] / scaled_input.width;
+            const float cy = p[1] / p[2] / scaled_input.height;
+            out[2 * i] = cx;
+            out[2 * i + 1] = cy;
+            
+            // Ramp down towards the image border
+            const float border = std::min(std::min(cx, 1.0f - cx), std::min(cy, 1.0f - cy));
+            weights[i] = std::min(std::max(border / DIRECT_PROJECTION_FEATHER, 0.0f), 1.0f);
+        }
+        
+        // Keep the two strongest cameras
+        int first = 0;
+        for (int i = 1; i < num_cameras; i++) {
+            if (weights[i] > weights[first]) first = i;
+        }
+        int second = (first == 0) ? 1 : 0;
+        for (int i = 0; i < num_cameras; i++) {
+            if (i != first && weights[i] > weights[second]) second = i;
+        }
+        
+        const float sum = weights[first] + weights[second];
+        for (int i = 0; i < num_cameras; i++) {
+            weights[i] = (sum > 0.0f && (i == first || i == second)) ? weights[i] / sum : 0.0f;
+        }
+        
+        if (sum > 0.0f) {
+            covered++;
+        }
+    }
+    
+    std::cout << "Bowl projection computed: " << covered << "/" << vertex_count
+              << " vertices covered by a camera" << std::endl;
+    
+    return true;
+}
@@ -0,0 +1,360 @@
+/**
+ * SVStreamOutput.cpp
+ * H.264 encoding of output frames through a GStreamer appsrc
+ */
+
+#include "SVStreamOutput.hpp"
+#include <sstream>
+
+// Logging macros (matching SVEthernetCamera.cpp)
+#define LOG_DEBUG(msg, ...)   printf("DEBUG:   " msg "\n", ##__VA_ARGS__)
+#define LOG_WARNING(msg, ...) printf("WARNING: " msg "\n", ##__VA_ARGS__)
+#define LOG_ERROR(msg, ...)   printf("ERROR:   " msg "\n", ##__VA_ARGS__)
+
+namespace {
+
+const char UDP_SCHEME[] = "udp://";
+
+bool hasSuffix(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool elementAvailable(const char* name) {
+    GstElementFactory* factory = gst_element_factory_find(name);
+    if (!factory) return false;
+    gst_object_unref(factory);
+    return true;
+}
+
+} // namespace
+
+SVStreamOutput::SVStreamOutput()
+    : pipeline(nullptr)
+    , appsrc(nullptr)
+    , bus(nullptr)
+    , pool(nullptr)
+    , frame_channels(0)
+    , frame_rate(0)
+    , failed(false)
+    , pending_head(0)
+    , last_pts(GST_CLOCK_TIME_NONE)
+    , pushed_frames(0)
+    , dropped_frames(0)
+    , encoded_frames(0)
+    , last_latency_ms(0.0f)
+    , total_latency_ms(0.0)
+{
+    for (auto& frame : pending) {
+        frame.pts = GST_CLOCK_TIME_NONE;
+    }
+}
+
+SVStreamOutput::~SVStreamOutput() {
+    close();
+}
+
+std::string SVStreamOutput::selectEncoder() {
+    std::ostringstream encoder;
+
+    if (elementAvailable("nvv4l2h264enc")) {
+        // Jetson: colour conversion on the VIC, encoder reads NVMM buffers
+        encoder_name = "nvv4l2h264enc";
+        if (frame_channels == 3) {
+            encoder << "videoconvert ! video/x-raw,format=BGRx ! ";
+        }
+        encoder << "nvvidconv ! video/x-raw(memory:NVMM),format=I420 "
+                << " ! nvv4l2h264enc name=enc bitrate=" << STREAM_BITRATE_KBPS * 1000
+                << " iframeinterval=" << frame_rate
+                << " insert-sps-pps=true maxperf-enable=true";
+    } else if (elementAvailable("nvh264enc")) {
+        // Desktop NVENC
+        encoder_name = "nvh264enc";
+        encoder << "videoconvert ! video/x-raw,format=I420 "
+                << " ! nvh264enc name=enc bitrate=" << STREAM_BITRATE_KBPS
+                << " gop-size=" << frame_rate;
+    } else {
+        encoder_name = "x264enc";
+        encoder << "videoconvert ! video/x-raw,format=I420 "
+                << " ! x264enc name=enc tune=zerolatency speed-preset=ultrafast"
+                << " bitrate=" << STREAM_BITRATE_KBPS
+                << " key-int-max=" << frame_rate;
+    }
+
+    return encoder.str();
+}
+
+std::string SVStreamOutput::createPipelineString(const std::string& encoder) const {
+    std::ostringstream pipeline;
+
+    pipeline << "appsrc name=src is-live=true format=time do-timestamp=false block=false "
+             << " ! " << encoder
+             << " ! h264parse ";
+
+    if (target.compare(0, sizeof(UDP_SCHEME) - 1, UDP_SCHEME) == 0) {
+        const std::string address = target.substr(sizeof(UDP_SCHEME) - 1);
+        const size_t colon = address.rfind(':');
+        pipeline << " ! rtph264pay config-interval=1 pt=96 "
+                 << " ! udpsink host=" << address.substr(0, colon)
+                 << " port=" << address.substr(colon + 1)
+                 << " sync=false async=false";
+    } else {
+        if (hasSuffix(target, ".mp4")) {
+            pipeline << " ! mp4mux ";
+        } else if (hasSuffix(target, ".mkv")) {
+            pipeline << " ! matroskamux ";
+        } else {
+            pipeline << " ! video/x-h264,stream-format=byte-stream ";
+        }
+        pipeline << " ! filesink location=\"" << target << "\" sync=false async=false";
+    }
+
+    return pipeline.str();
+}
+
+bool SVStreamOutput::init(const cv::Size& size, int channels, int fps, const std::string& target_) {
+    if (pipeline) {
+        LOG_WARNING("Output stream already initialized");
+        return true;
+    }
+
+    if (channels != 3 && channels != 4) {
+        LOG_ERROR("Output stream: unsupported channel count %d", channels);
+        return false;
+    }
+
+    frame_size = size;
+    frame_channels = channels;
+    frame_rate = fps > 0 ? fps : 30;
+    target = target_;
+    failed = false;
+
+    if (target.compare(0, sizeof(UDP_SCHEME) - 1, UDP_SCHEME) == 0 &&
+        target.rfind(':') < sizeof(UDP_SCHEME)) {
+        LOG_ERROR("Output stream: expected udp://host:port, got %s", target.c_str());
+        return false;
+    }
+
+    if (!gst_is_initialized()) {
+        gst_init(nullptr, nullptr);
+    }
+
+    std::string pipelineStr = createPipelineString(selectEncoder());
+    LOG_DEBUG("Output stream pipeline: %s", pipelineStr.c_str());
+
+    GError* error = nullptr;
+    pipeline = gst_parse_launch(pipelineStr.c_str(), &error);
+
+    if (!pipeline || error) {
+        LOG_ERROR("Output stream: failed to create pipeline: %s", error ? error->message : "unknown");
+        if (error) g_error_free(error);
+        if (pipeline) {
+            gst_object_unref(pipeline);
+            pipeline = nullptr;
+        }
+        return false;
+    }
+
+    appsrc = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+    GstElement* encoder = gst_bin_get_by_name(GST_BIN(pipeline), "enc");
+    if (!appsrc || !encoder) {
+        LOG_ERROR("Output stream: appsrc or encoder missing from pipeline");
+        if (encoder) gst_object_unref(encoder);
+        close();
+        return false;
+    }
+
+    // Alpha of BGRA frames is ignored
+    std::ostringstream caps_str;
+    caps_str << "video/x-raw,format=" << (channels == 4 ? "BGRx" : "BGR")
+             << ",width=" << size.width << ",height=" << size.height
+             << ",framerate=" << frame_rate << "/1";
+    GstCaps* caps = gst_caps_from_string(caps_str.str().c_str());
+    gst_app_src_set_caps(GST_APP_SRC(appsrc), caps);
+
+    // Frames in flight are bounded by the pool; acquire never waits (see push)
+    const guint frame_bytes = static_cast<guint>(size.area() * channels);
+    pool = gst_buffer_pool_new();
+    GstStructure* config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, caps, frame_bytes, 0, STREAM_QUEUE_DEPTH);
+    gst_caps_unref(caps);
+    if (!gst_buffer_pool_set_config(pool, config) || !gst_buffer_pool_set_active(pool, TRUE)) {
+        LOG_ERROR("Output stream: failed to set up the buffer pool");
+        gst_object_unref(encoder);
+        close();
+        return false;
+    }
+
+    // Encoded frames leave the encoder here
+    GstPad* encoded_pad = gst_element_get_static_pad(encoder, "src");
+    gst_pad_add_probe(encoded_pad, GST_PAD_PROBE_TYPE_BUFFER, &SVStreamOutput::encodedProbe, this, nullptr);
+    gst_object_unref(encoded_pad);
+    gst_object_unref(encoder);
+
+    bus = gst_element_get_bus(pipeline);
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        LOG_ERROR("Output stream: failed to start pipeline");
+        close();
+        return false;
+    }
+
+    start_time = std::chrono::steady_clock::now();
+    last_pts = GST_CLOCK_TIME_NONE;
+
+    LOG_DEBUG("Output stream started: %dx%d @ %d fps, %s -> %s",
+              size.width, size.height, frame_rate, encoder_name.c_str(), target.c_str());
+
+    return true;
+}
+
+bool SVStreamOutput::push(const cv::Mat& frame, bool bottom_up) {
+    auto pushed = std::chrono::steady_clock::now();
+
+    if (!pipeline || !checkBus()) {
+        return false;
+    }
+
+    if (frame.size() != frame_size || frame.type() != CV_8UC(frame_channels)) {
+        dropped_frames++;
+        return false;
+    }
+
+    // All pool buffers in flight: the encoder is behind, drop this frame
+    GstBuffer* buffer = nullptr;
+    GstBufferPoolAcquireParams params = {};
+    params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+    if (gst_buffer_pool_acquire_buffer(pool, &buffer, &params) != GST_FLOW_OK) {
+        dropped_frames++;
+        return false;
+    }
+
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+        gst_buffer_unref(buffer);
+        dropped_frames++;
+        return false;
+    }
+
+    cv::Mat dst(frame_size, frame.type(), map.data);
+    if (bottom_up) {
+        cv::flip(frame, dst, 0);
+    } else {
+        frame.copyTo(dst);
+    }
+    gst_buffer_unmap(buffer, &map);
+
+    std::lock_guard<std::mutex> lock(pending_mutex);
+
+    // Live timestamps, strictly increasing so they identify the frame at the encoder output
+    GstClockTime pts = static_cast<GstClockTime>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(pushed - start_time).count());
+    if (last_pts != GST_CLOCK_TIME_NONE && pts <= last_pts) {
+        pts = last_pts + 1;
+    }
+    last_pts = pts;
+
+    GST_BUFFER_PTS(buffer) = pts;
+    GST_BUFFER_DURATION(buffer) = GST_SECOND / frame_rate;
+
+    pending[pending_head % pending.size()] = {pts, pushed};
+    pending_head++;
+
+    // Takes ownership of the buffer
+    if (gst_app_src_push_buffer(GST_APP_SRC(appsrc), buffer) != GST_FLOW_OK) {
+        dropped_frames++;
+        return false;
+    }
+
+    pushed_frames++;
+    return true;
+}
+
+GstPadProbeReturn SVStreamOutput::encodedProbe(GstPad* pad, GstPadProbeInfo* info, gpointer data) {
+    (void)pad;
+    auto* self = static_cast<SVStreamOutput*>(data);
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+
+    if (pts == GST_CLOCK_TIME_NONE) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(self->pending_mutex);
+
+    for (auto& frame : self->pending) {
+        if (frame.pts == pts) {
+            float latency = std::chrono::duration<float, std::milli>(now - frame.pushed).count();
+            frame.pts = GST_CLOCK_TIME_NONE;
+
+            // Only written here, on the encoder's streaming thread
+            self->last_latency_ms.store(latency, std::memory_order_relaxed);
+            self->total_latency_ms.store(self->total_latency_ms.load(std::memory_order_relaxed) + latency,
+                                         std::memory_order_relaxed);
+            self->encoded_frames++;
+            break;
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+float SVStreamOutput::getMeanEncodeLatencyMs() const {
+    unsigned long encoded = encoded_frames.load(std::memory_order_relaxed);
+    if (encoded == 0) return 0.0f;
+    return static_cast<float>(total_latency_ms.load(std::memory_order_relaxed) / encoded);
+}
+
+bool SVStreamOutput::checkBus() {
+    if (failed) return false;
+    if (!bus) return true;
+
+    GstMessage* msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+    if (msg) {
+        GError* err;
+        gchar* debug;
+        gst_message_parse_error(msg, &err, &debug);
+        LOG_ERROR("Output stream error: %s", err->message);
+        g_error_free(err);
+        g_free(debug);
+        gst_message_unref(msg);
+        failed = true;
+    }
+
+    return !failed;
+}
+
+void SVStreamOutput::close() {
+    if (!pipeline) return;
+
+    // Let muxers finish the file; the UDP branch simply drains
+    if (bus && checkBus()) {
+        gst_app_src_end_of_stream(GST_APP_SRC(appsrc));
+        GstMessage* msg = gst_bus_timed_pop_filtered(bus, 2 * GST_SECOND,
+                                                     static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        if (msg) {
+            gst_message_unref(msg);
+        } else {
+            LOG_WARNING("Output stream: timed out waiting for end of stream");
+        }
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+
+    if (bus) gst_object_unref(bus);
+    if (appsrc) gst_object_unref(appsrc);
+    gst_object_unref(pipeline);
+    bus = nullptr;
+    appsrc = nullptr;
+    pipeline = nullptr;
+
+    if (pool) {
+        gst_buffer_pool_set_active(pool, FALSE);
+        gst_object_unref(pool);
+        pool = nullptr;
+    }
+
+    LOG_DEBUG("Output stream closed: %lu frames encoded, %lu dropped, mean latency %.2f ms",
+              getEncodedCount(), getDroppedCount(), getMeanEncodeLatencyMs());
+}
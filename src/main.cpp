@@ -1,12 +1,13 @@
 #include "SVAppSimple.hpp"
 #include <iostream>
 #include <csignal>
+#include <cstring>
 
-volatile bool g_running = true;
+static SVAppSimple* g_app = nullptr;
 
 void signalHandler(int signum) {
-    std::cout << "\nInterrupt signal (" << signum << ") received." << std::endl;
-    g_running = false;
+    (void)signum;
+    if (g_app) g_app->requestStop();
 }
 
 int main(int argc, char** argv) {
@@ -19,20 +20,29 @@ int main(int argc, char** argv) {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
-    // Get calibration folder from command line or use default
+    // Usage: surround_view [--headless] [calib_folder]
     std::string calib_folder = "camparameters";
-    if (argc > 1) {
-        calib_folder = argv[1];
+    bool headless = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else {
+            calib_folder = argv[i];
+        }
     }
     
     std::cout << "\nCalibration folder: " << calib_folder << std::endl;
+    if (headless) {
+        std::cout << "Headless mode (EGL offscreen)" << std::endl;
+    }
     
     // Create application
     SVAppSimple app;
+    g_app = &app;
     
     // Initialize
     std::cout << "\n--- Initialization Phase ---" << std::endl;
-    if (!app.init(calib_folder)) {
+    if (!app.init(calib_folder, headless)) {
         std::cerr << "\nERROR: Failed to initialize application" << std::endl;
         return -1;
     }
@@ -45,6 +55,7 @@ int main(int argc, char** argv) {
     // Cleanup
     std::cout << "\n--- Shutting down ---" << std::endl;
     app.stop();
+    g_app = nullptr;
     
     std::cout << "Goodbye!" << std::endl;
     return 0;
@@ -0,0 +1,224 @@
+#include "Bowl.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Usage: BowlMeshBench [iterations]
+// Generates bowl meshes (plain, uv, hole, uv + hole) across grid sizes with Bowl and with the
+// previous meshgrid-based generator, checks that vertices and indices are identical and
+// reports the time of both. Exit code 1 if any mesh differs.
+
+namespace {
+
+// Renderer bowl (SVRenderSimple::setupBowl)
+constexpr float disk_radius = 0.4f, parab_radius = 0.55f, hole_radius = 0.08f;
+constexpr float param_a = 0.4f, param_b = 0.4f, param_c = 0.2f;
+constexpr float PI = 3.14159265359f;
+
+/*
+        previous Bowl::generate_mesh_ (meshgrid, per-element trig and pow, push_back, two grid scans),
+        the reference the row-parallel generator has to reproduce exactly
+*/
+class ReferenceBowl {
+public:
+        ReferenceBowl(const bool hole, const bool uv) : set_hole(hole), useUV(uv), hole_rad(hole ? hole_radius : 0.f) {}
+
+        void generate(const float max_size_vert, std::vector<float>& vertices, std::vector<uint>& indices)
+        {
+                auto a = param_a;
+                auto b = param_b;
+                auto c = param_c;
+
+                vertices.clear();
+                indices.clear();
+
+                std::vector<float> texture_u = meshgen::linspace(0.f, Bowl::uv_scale, max_size_vert);
+                auto texture_v = texture_u;
+
+                auto r = meshgen::linspace(hole_rad, parab_radius, max_size_vert);
+                auto theta = meshgen::linspace(0.f, 2 * PI, max_size_vert);
+                auto mesh_pair = meshgen::meshgrid(r, theta);
+
+                auto R = std::get<0>(mesh_pair);
+                auto THETA = std::get<1>(mesh_pair);
+                size_t grid_size = R.size();
+                std::vector<float> x_grid;
+                std::vector<float> y_grid;
+                std::vector<float> z_grid;
+
+                for (size_t i = 0; i < grid_size; ++i) {
+                        for (size_t j = 0; j < grid_size; ++j) {
+                                auto x = R(i, j) * cos(THETA(i, j));
+                                auto z = R(i, j) * sin(THETA(i, j));
+                                auto y = c * (pow((x / a), 2) + pow((z / b), 2));
+                                x_grid.push_back(x);
+                                z_grid.push_back(z);
+                                y_grid.push_back(y);
+                        }
+                }
+
+                auto min_y = 0.f;
+                auto idx_min_y = 0u;
+                for (size_t i = 0; i < grid_size; ++i) {
+                        for (size_t j = 0; j < grid_size; ++j) {
+                                auto x = x_grid[j + i * grid_size];
+                                auto z = z_grid[j + i * grid_size];
+                                if (lt_radius(x, z, disk_radius)) {
+                                        min_y = y_grid[j + i * grid_size];
+                                        idx_min_y = i;
+                                        break;
+                                }
+                        }
+                }
+
+                auto half_grid = grid_size / 2;
+                auto vertices_size = 0;
+                for (size_t i = 0; i < grid_size; ++i) {
+                        for (size_t j = 0; j < grid_size; ++j) {
+                                auto x = x_grid[j + i * grid_size];
+                                auto z = z_grid[j + i * grid_size];
+
+                                auto y = min_y;
+                                if (gt_radius(x, z, disk_radius))
+                                        y = y_grid[j + i * grid_size];
+
+                                vertices.push_back(x + cen[0]);
+                                vertices.push_back(y + cen[1]);
+                                vertices.push_back(z + cen[2]);
+                                vertices_size += 3;
+
+                                if (useUV) {
+                                        auto u = texture_u[j];
+                                        auto v = texture_v[i];
+                                        if (i == 0 && j == 0 &&  !set_hole)
+                                            u = texture_u[half_grid];
+                                        vertices.push_back(u);
+                                        vertices.push_back(v);
+                                }
+                        }
+                }
+
+                generate_indices(indices, grid_size, idx_min_y, vertices_size / 3);
+        }
+
+private:
+        void generate_indices(std::vector<uint>& indices, const uint grid_size, const uint idx_min_y, const uint last_vert)
+        {
+                bool oddRow = false;
+                for (uint y = 0; y < grid_size - 1; ++y) {
+                        if (!oddRow) {
+                                for (uint x = 0; x < grid_size; ++x) {
+                                        auto current = y * grid_size + x;
+                                        auto next = (y + 1) * grid_size + x;
+                                        if (y == idx_min_y && x == 0) {
+                                                std::swap(current, next);
+                                                indices.push_back(current - grid_size);
+                                                indices.push_back(next);
+                                                indices.push_back(current);
+                                                continue;
+                                        }
+                                        if (set_hole && (current >= last_vert || next >= last_vert))
+                                                continue;
+                                        indices.push_back(current);
+                                        indices.push_back(next);
+                                }
+                        } else {
+                                for (int x = grid_size - 1; x >= 0; --x) {
+                                        auto current = (y + 1) * grid_size + x;
+                                        auto prev = y * grid_size + x;
+                                        if (y == idx_min_y && static_cast<uint>(x) == grid_size - 1) {
+                                                indices.push_back(current - grid_size);
+                                                indices.push_back(current);
+                                                indices.push_back(prev);
+                                                continue;
+                                        }
+                                        if (set_hole && (current >= last_vert || prev >= last_vert))
+                                                continue;
+                                        indices.push_back(current);
+                                        indices.push_back(prev);
+                                }
+                        }
+                        oddRow = !oddRow;
+                }
+        }
+
+        bool lt_radius(const float x, const float z, const float radius) {
+                return pow((x - cen[0]), 2) + pow((z - cen[2]), 2) <= pow(radius, 2);
+        }
+        bool gt_radius(const float x, const float z, const float radius) {
+                return pow((x - cen[0]), 2) + pow((z - cen[2]), 2) > pow(radius, 2);
+        }
+
+        const float cen[3] = {0.f, 0.f, 0.f};  // as Bowl's default center
+        bool set_hole;
+        bool useUV;
+        float hole_rad;
+};
+
+bool generate(Bowl& bowl, const bool hole, const bool uv, const float grid, std::vector<float>& vertices, std::vector<uint>& indices)
+{
+        if (hole)
+                return uv ? bowl.generate_mesh_uv_hole(grid, hole_radius, vertices, indices)
+                          : bowl.generate_mesh_hole(grid, hole_radius, vertices, indices);
+        return uv ? bowl.generate_mesh_uv(grid, vertices, indices) : bowl.generate_mesh(grid, vertices, indices);
+}
+
+template <typename Fn>
+double meanMs(const int iterations, const Fn& fn)
+{
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+                fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+        const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+        const float grids[] = {50.f, 100.f, 250.f, 500.f, 750.f, 1000.f, 1500.f};
+        const char* variants[] = {"plain", "uv", "hole", "uv+hole"};
+
+        int mismatches = 0;
+
+        for (const float grid : grids) {
+                for (int variant = 0; variant < 4; ++variant) {
+                        const bool uv = variant & 1;
+                        const bool hole = variant & 2;
+                        // Fresh bowls: hole_rad stays set after a hole mesh, in both generators
+                        Bowl bowl(disk_radius, parab_radius, param_a, param_b, param_c);
+                        ReferenceBowl reference(hole, uv);
+
+                        std::vector<float> vertices, ref_vertices;
+                        std::vector<uint> indices, ref_indices;
+                        if (!generate(bowl, hole, uv, grid, vertices, indices)) {
+                                std::cerr << "Generation failed: " << grid << " " << variants[variant] << std::endl;
+                                return 1;
+                        }
+                        reference.generate(grid, ref_vertices, ref_indices);
+
+                        const bool same = vertices.size() == ref_vertices.size() && indices == ref_indices &&
+                                std::memcmp(vertices.data(), ref_vertices.data(), vertices.size() * sizeof(float)) == 0;
+                        mismatches += same ? 0 : 1;
+
+                        // Fewer reference runs on large grids, it is several times slower
+                        const int ref_iterations = std::max(1, iterations * 250 / static_cast<int>(grid));
+                        const double ms = meanMs(iterations, [&] { generate(bowl, hole, uv, grid, vertices, indices); });
+                        const double ref_ms = meanMs(std::min(iterations, ref_iterations),
+                                                     [&] { reference.generate(grid, ref_vertices, ref_indices); });
+
+                        std::cout << grid << "x" << grid << " " << variants[variant] << ": " << ms
+                                  << " ms (previous " << ref_ms << " ms, x" << ref_ms / ms << ")"
+                                  << (same ? "" : "  OUTPUT DIFFERS") << std::endl;
+                }
+        }
+
+        std::cout << (mismatches == 0 ? "All meshes identical to the previous generator"
+                                       : std::to_string(mismatches) + " meshes differ") << std::endl;
+        return mismatches == 0 ? 0 : 1;
+}
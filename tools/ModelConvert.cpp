@@ -0,0 +1,33 @@
+#include <ModelBinary.hpp>
+#include <chrono>
+#include <iostream>
+
+// Usage: ModelConvert <model.obj> [output]
+// Writes the preprocessed model next to the source (<model.obj>.svmodel) by default
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model.obj> [output" << MODEL_BINARY_EXT << "]" << std::endl;
+        return 1;
+    }
+    
+    const std::string model_path = argv[1];
+    const std::string binary_path = argc > 2 ? argv[2] : ModelBinary::binaryPath(model_path);
+    
+    auto start = std::chrono::steady_clock::now();
+    if (!ModelBinary::convert(model_path, binary_path)) {
+        std::cerr << "Conversion failed: " << model_path << std::endl;
+        return 1;
+    }
+    float convert_ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    // Check the result maps back (only valid at the default path, the loader looks there)
+    ModelBinary binary;
+    if (binary_path == ModelBinary::binaryPath(model_path) && !binary.load(binary_path, model_path)) {
+        std::cerr << "Written file does not load: " << binary_path << std::endl;
+        return 1;
+    }
+    
+    std::cout << model_path << " -> " << binary_path << " (" << convert_ms << " ms)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <SVSharedFrameRing.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Usage: ShmLatencyTest [name] [frames] [--self]
+// Reads frames from the shared ring (default /sv_stitched) and reports the delay from
+// publish (and from capture) until the frame was read in place, plus torn and skipped frames.
+// --self runs a synthetic 1920x1080 BGR publisher at 30 fps in this process (no app needed).
+
+namespace {
+
+void printStats(const char* label, std::vector<double>& samples) {
+    if (samples.empty()) {
+        std::cout << label << ": no samples" << std::endl;
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double value : samples) sum += value;
+    std::cout << label << " (ms): min " << samples.front()
+              << " | mean " << sum / samples.size()
+              << " | p50 " << samples[samples.size() / 2]
+              << " | p99 " << samples[std::min(samples.size() - 1, samples.size() * 99 / 100)]
+              << " | max " << samples.back() << std::endl;
+}
+
+void publishSynthetic(const std::string& name, std::atomic<bool>& running) {
+    const uint32_t width = 1920, height = 1080, channels = 3;
+    SVShmFramePublisher publisher;
+    if (!publisher.init(name, width, height, channels, 4)) {
+        running = false;
+        return;
+    }
+
+    auto next = std::chrono::steady_clock::now();
+    uint8_t value = 0;
+    while (running) {
+        const uint64_t capture_ns = svShmNowNs();
+        uint8_t* frame = publisher.beginWrite();
+        std::memset(frame, value++, static_cast<size_t>(publisher.getStride()) * height);
+        publisher.endWrite(capture_ns);
+
+        next += std::chrono::microseconds(33333);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string name = "/sv_stitched";
+    long frames = 300;
+    bool self_publish = false;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--self") == 0) {
+            self_publish = true;
+        } else if (positional++ == 0) {
+            name = argv[i];
+        } else {
+            frames = std::atol(argv[i]);
+        }
+    }
+
+    std::atomic<bool> running(true);
+    std::thread publisher_thread;
+    if (self_publish) {
+        publisher_thread = std::thread(publishSynthetic, name, std::ref(running));
+    }
+
+    SVShmFrameReader reader;
+    for (int attempt = 0; !reader.open(name); attempt++) {
+        if (attempt == 50 || !running) {
+            std::cerr << "Shared ring " << name << " not available" << std::endl;
+            running = false;
+            if (publisher_thread.joinable()) publisher_thread.join();
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    const SVShmRingHeader* header = reader.getHeader();
+    std::cout << "Reading " << name << ": " << header->width << "x" << header->height << "x" << header->channels
+              << ", " << header->slot_count << " slots" << std::endl;
+
+    // Frames already in the ring when the reader joined are not counted
+    const uint64_t opened_ns = svShmNowNs();
+    std::vector<double> publish_latency, capture_latency;
+    long torn = 0;
+    uint64_t checksum = 0;
+
+    while (static_cast<long>(publish_latency.size()) < frames) {
+        if (!reader.waitForFrame(1000)) {
+            if (reader.isPublisherClosed()) {
+                std::cerr << "Publisher closed the ring" << std::endl;
+                break;
+            }
+            continue;
+        }
+
+        SVShmFrameReader::View view;
+        if (!reader.acquireLatest(view) || view.publish_ns < opened_ns) {
+            continue;
+        }
+        const uint64_t acquired_ns = svShmNowNs();
+
+        // Touch every row in place, as a consumer would
+        for (uint32_t y = 0; y < header->height; y++) {
+            checksum += view.data[static_cast<size_t>(y) * header->stride];
+        }
+
+        if (!reader.isValid(view)) {
+            torn++;
+            continue;
+        }
+
+        publish_latency.push_back((acquired_ns - view.publish_ns) / 1e6);
+        capture_latency.push_back((acquired_ns - view.capture_ns) / 1e6);
+    }
+
+    running = false;
+    if (publisher_thread.joinable()) publisher_thread.join();
+
+    std::cout << publish_latency.size() << " frames, " << torn << " torn, "
+              << reader.getSkippedCount() << " skipped (checksum " << checksum << ")" << std::endl;
+    printStats("Publish -> read", publish_latency);
+    printStats("Capture -> read", capture_latency);
+    return 0;
+}